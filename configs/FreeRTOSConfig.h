@@ -98,8 +98,19 @@ extern uint32_t SystemCoreClock;
 #define configUSE_MALLOC_FAILED_HOOK            1
 #define configUSE_DAEMON_TASK_STARTUP_HOOK      0
 
-/* Run time and task stats gathering related definitions. */
+/* Run time and task stats gathering related definitions. The run time
+ * counter is provided by runtime_stats.c when ENABLE_RUNTIME_STATS is set. */
+#ifdef ENABLE_RUNTIME_STATS
+#if defined (__ICCARM__) || (__GNUC__)
+extern void runtime_stats_timer_init(void);
+extern uint32_t runtime_stats_counter(void);
+#endif
+#define configGENERATE_RUN_TIME_STATS           1
+#define portCONFIGURE_TIMER_FOR_RUN_TIME_STATS() runtime_stats_timer_init()
+#define portGET_RUN_TIME_COUNTER_VALUE()        runtime_stats_counter()
+#else
 #define configGENERATE_RUN_TIME_STATS           0
+#endif
 #define configUSE_TRACE_FACILITY                1
 #define configUSE_STATS_FORMATTING_FUNCTIONS    0
 
@@ -171,7 +182,22 @@ standard names - or at least those used in the unmodified vector table. */
 #define HEAP_ALLOCATION_TYPE5                   (5)     /* heap_5.c*/
 #define NO_HEAP_ALLOCATION                      (0)
 
+/* Heap selected with RTOS_HEAP in the Makefile. TLSF is provided by
+ * rtos_heap.c, heap_3 and heap_4 by the FreeRTOS library. */
+#define RTOS_HEAP_MALLOC                        (0)     /* C library malloc, heap_3.c */
+#define RTOS_HEAP_HEAP4                         (1)     /* heap_4.c */
+#define RTOS_HEAP_TLSF                          (2)     /* tlsf_heap.c */
+#ifndef RTOS_HEAP
+#define RTOS_HEAP                               RTOS_HEAP_MALLOC
+#endif
+
+#if (RTOS_HEAP == RTOS_HEAP_HEAP4)
+#define configHEAP_ALLOCATION_SCHEME            (HEAP_ALLOCATION_TYPE4)
+#elif (RTOS_HEAP == RTOS_HEAP_TLSF)
+#define configHEAP_ALLOCATION_SCHEME            (NO_HEAP_ALLOCATION)
+#else
 #define configHEAP_ALLOCATION_SCHEME            (HEAP_ALLOCATION_TYPE3)
+#endif
 
 /* Check if the ModusToolbox Device Configurator Power personality parameter
  * "System Idle Power Mode" is set to either "CPU Sleep" or "System Deep Sleep".
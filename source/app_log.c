@@ -0,0 +1,395 @@
+/*******************************************************************************
+* File Name: app_log.c
+*
+* Description: This file contains the deferred application log. Log calls
+*              store a format ID and their arguments in a RAM ring, and a
+*              low priority task formats them to the debug UART.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "cybsp.h"
+#include "cy_retarget_io.h"
+#ifdef WICED_BT_MESH_TRACE_ENABLE
+#include "wiced_bt_mesh_core.h"
+#include "wiced_bt_mesh_models.h"
+#endif
+#include "FreeRTOS.h"
+#include "task.h"
+#include "app_log.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#ifndef APP_LOG_RING_SIZE
+#define APP_LOG_RING_SIZE               (64u)   /* records, power of two */
+#endif
+
+#define APP_LOG_TASK_PRIORITY           (tskIDLE_PRIORITY + 1u)
+#define APP_LOG_TASK_STACK_SIZE         (512u)
+#define APP_LOG_DRAIN_INTERVAL_MS       (20u)
+
+/* Benchmark rounds. The enabled rounds must fit in the ring. */
+#define APP_LOG_BENCH_OFF_ROUNDS        (1000u)
+#define APP_LOG_BENCH_ON_ROUNDS         (APP_LOG_RING_SIZE / 2u)
+
+/*******************************************************************************
+ * Variables Definitions
+ ******************************************************************************/
+/* One log call. The sequence is written last and marks the record as
+ * complete for the log task. */
+typedef struct
+{
+    uint16_t id;
+    uint16_t seq;
+    uint32_t arg[APP_LOG_MAX_ARGS];
+} app_log_record_t;
+
+#define APP_LOG_FORMAT(name, module, level, fmt)    fmt,
+#define APP_LOG_MODULE_LEVEL(name, level)           level,
+
+static const char *const app_log_formats[APP_LOG_NUM_FORMATS] =
+{
+    APP_LOG_FORMATS(APP_LOG_FORMAT)
+};
+
+uint8_t app_log_levels[APP_LOG_NUM_MODULES] =
+{
+    APP_LOG_MODULES(APP_LOG_MODULE_LEVEL)
+};
+
+static app_log_record_t app_log_ring[APP_LOG_RING_SIZE];
+static uint32_t app_log_head = 0u;              /* next record to reserve */
+static uint32_t app_log_tail = 0u;              /* next record to format */
+static uint32_t app_log_drop_count = 0u;
+
+static TaskHandle_t app_log_task_handle = NULL;
+
+_Static_assert((APP_LOG_RING_SIZE & (APP_LOG_RING_SIZE - 1u)) == 0u, "APP_LOG_RING_SIZE must be a power of two");
+
+/*******************************************************************************
+ * Function Name: app_log_put
+ *******************************************************************************
+ * Summary:
+ *  Store a log record. The record is reserved with a compare-and-swap on the
+ *  ring head, so this can be called from any task or interrupt without a
+ *  lock. The record is dropped if the ring is full.
+ *
+ * Parameters:
+ *  app_log_id_t id : format of the record
+ *  uint32_t arg0..arg3 : format arguments
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void app_log_put(app_log_id_t id, uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3)
+{
+    uint32_t head = __atomic_load_n(&app_log_head, __ATOMIC_RELAXED);
+    app_log_record_t *p_record;
+
+    do
+    {
+        if((head - __atomic_load_n(&app_log_tail, __ATOMIC_ACQUIRE)) >= APP_LOG_RING_SIZE)
+        {
+            __atomic_fetch_add(&app_log_drop_count, 1u, __ATOMIC_RELAXED);
+            return;
+        }
+    } while(!__atomic_compare_exchange_n(&app_log_head, &head, head + 1u, true,
+                                          __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+    p_record = &app_log_ring[head & (APP_LOG_RING_SIZE - 1u)];
+    p_record->id = (uint16_t)id;
+    p_record->arg[0] = arg0;
+    p_record->arg[1] = arg1;
+    p_record->arg[2] = arg2;
+    p_record->arg[3] = arg3;
+    __atomic_store_n(&p_record->seq, (uint16_t)(head + 1u), __ATOMIC_RELEASE);
+}
+
+/*******************************************************************************
+ * Function Name: app_log_dropped
+ *******************************************************************************
+ * Summary:
+ *  Number of records dropped because the ring was full.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  uint32_t : dropped records since boot
+ *
+ ******************************************************************************/
+uint32_t app_log_dropped(void)
+{
+    return __atomic_load_n(&app_log_drop_count, __ATOMIC_RELAXED);
+}
+
+/*******************************************************************************
+ * Function Name: app_log_set_level
+ *******************************************************************************
+ * Summary:
+ *  Change the trace level of a module at run time. The mesh modules pass the
+ *  level on to the mesh library.
+ *
+ * Parameters:
+ *  uint8_t module : app_log_module_t
+ *  uint8_t level : APP_LOG_LEVEL_*
+ *
+ * Return:
+ *  bool : false if the module or level is not valid
+ *
+ ******************************************************************************/
+bool app_log_set_level(uint8_t module, uint8_t level)
+{
+    if((module >= APP_LOG_NUM_MODULES) || (level > APP_LOG_LEVEL_DEBUG))
+    {
+        return false;
+    }
+    __atomic_store_n(&app_log_levels[module], level, __ATOMIC_RELAXED);
+
+    if((APP_LOG_MOD_MESH_CORE == module) || (APP_LOG_MOD_MESH_MODELS == module))
+    {
+        app_log_apply_mesh_levels();
+    }
+    return true;
+}
+
+#ifdef WICED_BT_MESH_TRACE_ENABLE
+/*******************************************************************************
+ * Function Name: app_log_mesh_level
+ *******************************************************************************
+ * Summary:
+ *  Convert a trace level to the level of the mesh library.
+ *
+ * Parameters:
+ *  uint8_t level : APP_LOG_LEVEL_*
+ *
+ * Return:
+ *  uint8_t : WICED_BT_MESH_CORE_TRACE_*
+ *
+ ******************************************************************************/
+static uint8_t app_log_mesh_level(uint8_t level)
+{
+    switch(level)
+    {
+    case APP_LOG_LEVEL_ERROR:
+        return WICED_BT_MESH_CORE_TRACE_CRITICAL;
+    case APP_LOG_LEVEL_WARNING:
+        return WICED_BT_MESH_CORE_TRACE_WARNING;
+    case APP_LOG_LEVEL_INFO:
+        return WICED_BT_MESH_CORE_TRACE_INFO;
+    case APP_LOG_LEVEL_DEBUG:
+        return WICED_BT_MESH_CORE_TRACE_DEBUG;
+    default:
+        return WICED_BT_MESH_CORE_TRACE_NO_LOG;
+    }
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: app_log_apply_mesh_levels
+ *******************************************************************************
+ * Summary:
+ *  Set the mesh core and models library trace levels from their modules.
+ *  Called once the mesh core is initialized and on every change. Without
+ *  ENABLE_MESH_TRACES the library traces are not built in and the levels
+ *  have no effect.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void app_log_apply_mesh_levels(void)
+{
+#ifdef WICED_BT_MESH_TRACE_ENABLE
+    wiced_bt_mesh_core_set_trace_level(WICED_BT_MESH_CORE_TRACE_FID_ALL,
+                                       app_log_mesh_level(app_log_levels[APP_LOG_MOD_MESH_CORE]));
+    wiced_bt_mesh_models_set_trace_level(app_log_mesh_level(app_log_levels[APP_LOG_MOD_MESH_MODELS]));
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: app_log_task
+ *******************************************************************************
+ * Summary:
+ *  Format the complete records in order and report dropped records.
+ *
+ * Parameters:
+ *  void *pvParameters : not used
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void app_log_task(void *pvParameters)
+{
+    uint32_t reported_drops = 0u;
+    uint32_t drops;
+    app_log_record_t *p_record;
+
+    (void)pvParameters;
+
+    for(;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(APP_LOG_DRAIN_INTERVAL_MS));
+
+        for(;;)
+        {
+            p_record = &app_log_ring[app_log_tail & (APP_LOG_RING_SIZE - 1u)];
+            if(__atomic_load_n(&p_record->seq, __ATOMIC_ACQUIRE) != (uint16_t)(app_log_tail + 1u))
+            {
+                break;
+            }
+            if(p_record->id < APP_LOG_NUM_FORMATS)
+            {
+                printf(app_log_formats[p_record->id], p_record->arg[0], p_record->arg[1],
+                       p_record->arg[2], p_record->arg[3]);
+            }
+            __atomic_store_n(&app_log_tail, app_log_tail + 1u, __ATOMIC_RELEASE);
+        }
+
+        drops = app_log_dropped();
+        if(drops != reported_drops)
+        {
+            printf("Log records dropped:%ld\n", drops - reported_drops);
+            reported_drops = drops;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: app_log_init
+ *******************************************************************************
+ * Summary:
+ *  Create the log task.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void app_log_init(void)
+{
+    if(pdPASS != xTaskCreate(app_log_task, "Log Task", APP_LOG_TASK_STACK_SIZE, NULL,
+                             APP_LOG_TASK_PRIORITY, &app_log_task_handle))
+    {
+        printf("Failed to create log task.\r\n");
+        CY_ASSERT(0u);
+    }
+}
+
+#ifdef ENABLE_RUNTIME_STATS
+/*******************************************************************************
+ * Function Name: app_log_benchmark
+ *******************************************************************************
+ * Summary:
+ *  Measure the cycles of an INFO record at every level of its module with
+ *  the DWT cycle counter, the loop overhead removed. Below INFO the record
+ *  is only the level check, from INFO on it is stored in the ring. The
+ *  benchmark record has an empty format and prints nothing. The level of
+ *  the module is restored afterwards. Waits for the log task between the
+ *  levels, so it runs in a task of its own.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  uint32_t : cycles of a stored INFO record
+ *
+ ******************************************************************************/
+uint32_t app_log_benchmark(void)
+{
+    uint8_t saved_level = app_log_levels[APP_LOG_MOD_OF_BENCHMARK];
+    uint32_t drops = app_log_dropped();
+    uint32_t rounds;
+    uint32_t loop_cycles;
+    uint32_t loop;
+    uint32_t cycles;
+    uint32_t start;
+    uint32_t stored_cycles = 0u;
+
+    start = DWT->CYCCNT;
+    for(uint32_t i = 0u; i < APP_LOG_BENCH_OFF_ROUNDS; i++)
+    {
+        __asm volatile("" ::: "memory");
+    }
+    loop_cycles = DWT->CYCCNT - start;
+
+    printf("Trace benchmark, cycles per INFO record:\n");
+    for(uint8_t level = APP_LOG_LEVEL_OFF; level <= APP_LOG_LEVEL_DEBUG; level++)
+    {
+        rounds = (level >= APP_LOG_LEVEL_OF_BENCHMARK) ? APP_LOG_BENCH_ON_ROUNDS : APP_LOG_BENCH_OFF_ROUNDS;
+
+        /* Let the log task empty the ring */
+        vTaskDelay(pdMS_TO_TICKS(2u * APP_LOG_DRAIN_INTERVAL_MS));
+        app_log_levels[APP_LOG_MOD_OF_BENCHMARK] = level;
+
+        start = DWT->CYCCNT;
+        for(uint32_t i = 0u; i < rounds; i++)
+        {
+            /* The level is read again in every round */
+            __asm volatile("" ::: "memory");
+            APP_LOG1(BENCHMARK, i);
+        }
+        cycles = DWT->CYCCNT - start;
+        loop = (loop_cycles * rounds) / APP_LOG_BENCH_OFF_ROUNDS;
+        cycles = (cycles > loop) ? (cycles - loop) : 0u;
+
+        printf("  level %d: %ld.%02ld\n", level, cycles / rounds, ((cycles % rounds) * 100u) / rounds);
+        if(APP_LOG_LEVEL_OF_BENCHMARK == level)
+        {
+            stored_cycles = cycles / rounds;
+        }
+    }
+    app_log_levels[APP_LOG_MOD_OF_BENCHMARK] = saved_level;
+
+    if(app_log_dropped() != drops)
+    {
+        printf("  records dropped, enabled results include the full ring\n");
+    }
+    return stored_cycles;
+}
+#endif
+
+/* [] END OF FILE */
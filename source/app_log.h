@@ -0,0 +1,184 @@
+/*******************************************************************************
+* File Name: app_log.h
+*
+* Description: This file is the public interface of app_log.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef APP_LOG_H_
+#define APP_LOG_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "stdint.h"
+#include "stdbool.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Trace levels, a record is stored if its level is at or below the level of
+ * its module */
+#define APP_LOG_LEVEL_OFF           (0u)
+#define APP_LOG_LEVEL_ERROR         (1u)
+#define APP_LOG_LEVEL_WARNING       (2u)
+#define APP_LOG_LEVEL_INFO          (3u)
+#define APP_LOG_LEVEL_DEBUG         (4u)
+
+/* Records above this level are removed at compile time */
+#ifndef APP_LOG_LEVEL_MAX
+#define APP_LOG_LEVEL_MAX           APP_LOG_LEVEL_DEBUG
+#endif
+
+/* Mesh library traces are only built in with ENABLE_MESH_TRACES */
+#ifdef WICED_BT_MESH_TRACE_ENABLE
+#define APP_LOG_MESH_DEFAULT_LEVEL  APP_LOG_LEVEL_DEBUG
+#else
+#define APP_LOG_MESH_DEFAULT_LEVEL  APP_LOG_LEVEL_OFF
+#endif
+
+/* Trace modules and their level at boot. The IDs are the position in this
+ * table, the host MCU changes the levels with the TRACE_LEVEL setting. The
+ * mesh modules set the level of the mesh core and models library traces. */
+#define APP_LOG_MODULES(X) \
+    X(APP,                  APP_LOG_LEVEL_DEBUG) \
+    X(CLIENT,               APP_LOG_LEVEL_DEBUG) \
+    X(ADV,                  APP_LOG_LEVEL_DEBUG) \
+    X(PROXY,                APP_LOG_LEVEL_DEBUG) \
+    X(MESH_CORE,            APP_LOG_MESH_DEFAULT_LEVEL) \
+    X(MESH_MODELS,          APP_LOG_MESH_DEFAULT_LEVEL)
+
+#define APP_LOG_MODULE_ID(name, level)  APP_LOG_MOD_##name,
+
+typedef enum
+{
+    APP_LOG_MODULES(APP_LOG_MODULE_ID)
+    APP_LOG_NUM_MODULES
+} app_log_module_t;
+
+/* Log formats with their module and level. A call site only stores the
+ * format ID and up to APP_LOG_MAX_ARGS integer arguments, the log task
+ * formats them later. The IDs are the position in this table. */
+#define APP_LOG_FORMATS(X) \
+    X(SET_LEVEL,            CLIENT, DEBUG,  "Mesh client set level:%d transition time:%ld final:%d\n") \
+    X(LEVEL_TX_COMPLETE,    CLIENT, DEBUG,  "Mesh client level tx complete status:%d\n") \
+    X(LEVEL_STATUS,         CLIENT, INFO,   "Mesh client level status from 0x%04x present:%d target:%d\n") \
+    X(LIGHT_TX_COMPLETE,    CLIENT, DEBUG,  "Mesh client light tx complete status:%d\n") \
+    X(CTL_STATUS,           CLIENT, INFO,   "Mesh client CTL status from 0x%04x lightness:%d temperature:%d\n") \
+    X(LIGHTNESS_STATUS,     CLIENT, INFO,   "Mesh client lightness status from 0x%04x present:%d target:%d\n") \
+    X(SCENE_TX_COMPLETE,    CLIENT, DEBUG,  "Mesh client scene tx complete status:%d\n") \
+    X(SCENE_STATUS,         CLIENT, INFO,   "Mesh client scene status from 0x%04x status:%d current:%d target:%d\n") \
+    X(SCENE_RECALL,         CLIENT, INFO,   "Mesh client scene recall:%d\n") \
+    X(STEP_SYNCED,          CLIENT, DEBUG,  "Mesh client step synced to %d from 0x%04x\n") \
+    X(MOVE_START,           CLIENT, DEBUG,  "Mesh client move delta:%d per %dms\n") \
+    X(LEVEL_DELIVERED,      CLIENT, INFO,   "Mesh client level to 0x%04x delivered in %ldms\n") \
+    X(RAMP_DONE,            CLIENT, INFO,   "Mesh client ramp done, step mode messages:%d, a move would send:%ld\n") \
+    X(STEP_CADENCE,         CLIENT, INFO,   "Mesh client step cadence:%ldms jitter:%ldms max jitter:%ldms\n") \
+    X(MOVE_STOP,            CLIENT, INFO,   "Mesh client move stop level:%ld, move mode messages:%d, steps would send:%ld\n") \
+    X(FINAL_DELIVERED,      CLIENT, INFO,   "Mesh client final level to 0x%04x in %ldms, superseded:%d\n") \
+    X(DST_STATS,            CLIENT, INFO,   "Mesh client dst 0x%04x success:%d%% latency:%ldms pdus:%ld\n") \
+    X(FANOUT_SPREAD,        CLIENT, DEBUG,  "Mesh client fan-out measured start spread:%ldms over %d destinations\n") \
+    X(ADV_STATE,            ADV,    INFO,   "Advertisement State Changed:%d\n") \
+    X(ADV_STOPPED,          ADV,    INFO,   "BT adv stopped\r\n") \
+    X(SCAN_STATE,           ADV,    DEBUG,  "BT scan state change:%d\r\n") \
+    X(GATT_CONNECTED,       PROXY,  INFO,   "mesh app GATT connected status %d, id:%d \n") \
+    X(ADV_BACKOFF,          ADV,    DEBUG,  "Adv restart in %ldms, duty cycle:%ld.%ld%%\n") \
+    X(ADV_DISCOVERED,       ADV,    INFO,   "Provisioner connected %ldms after adv start, duty cycle:%ld.%ld%%\n") \
+    X(CONN_PARAMS,          PROXY,  INFO,   "Proxy link interval:%ldus latency:%ld timeout:%ldms, at most %ld proxy PDU/s\n") \
+    X(DATA_LENGTH,          PROXY,  DEBUG,  "Proxy link data length tx:%ld rx:%ld octets\n") \
+    X(FACTORY_RESET_ADV,    APP,    INFO,   "Factory reset to advertising in %ldms\n") \
+    X(BENCHMARK,            APP,    INFO,   "")
+
+#define APP_LOG_ID(name, module, level, fmt)        APP_LOG_##name,
+#define APP_LOG_ATTR(name, module, level, fmt)      APP_LOG_MOD_OF_##name = APP_LOG_MOD_##module, \
+                                                    APP_LOG_LEVEL_OF_##name = APP_LOG_LEVEL_##level,
+
+typedef enum
+{
+    APP_LOG_FORMATS(APP_LOG_ID)
+    APP_LOG_NUM_FORMATS
+} app_log_id_t;
+
+/* Module and level of every format as compile time constants */
+enum
+{
+    APP_LOG_FORMATS(APP_LOG_ATTR)
+};
+
+#define APP_LOG_MAX_ARGS            (4u)
+
+/* A disabled record costs the load of the module level and one branch, its
+ * arguments are not evaluated */
+#define APP_LOG_ENABLED(name)       ((APP_LOG_LEVEL_OF_##name <= APP_LOG_LEVEL_MAX) && \
+                                     __builtin_expect(app_log_levels[APP_LOG_MOD_OF_##name] >= \
+                                                      APP_LOG_LEVEL_OF_##name, 0))
+
+#define APP_LOG_PUT(name, a, b, c, d) \
+    do \
+    { \
+        if(APP_LOG_ENABLED(name)) \
+        { \
+            app_log_put(APP_LOG_##name, (uint32_t)(a), (uint32_t)(b), (uint32_t)(c), (uint32_t)(d)); \
+        } \
+    } while(0)
+
+#define APP_LOG0(name)              APP_LOG_PUT(name, 0u, 0u, 0u, 0u)
+#define APP_LOG1(name, a)           APP_LOG_PUT(name, a, 0u, 0u, 0u)
+#define APP_LOG2(name, a, b)        APP_LOG_PUT(name, a, b, 0u, 0u)
+#define APP_LOG3(name, a, b, c)     APP_LOG_PUT(name, a, b, c, 0u)
+#define APP_LOG4(name, a, b, c, d)  APP_LOG_PUT(name, a, b, c, d)
+
+/*******************************************************************************
+ * Variables Definitions
+ ******************************************************************************/
+/* Current level of every module, written with app_log_set_level() */
+extern uint8_t app_log_levels[APP_LOG_NUM_MODULES];
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void app_log_init(void);
+void app_log_put(app_log_id_t id, uint32_t arg0, uint32_t arg1, uint32_t arg2, uint32_t arg3);
+uint32_t app_log_dropped(void);
+bool app_log_set_level(uint8_t module, uint8_t level);
+void app_log_apply_mesh_levels(void);
+#ifdef ENABLE_RUNTIME_STATS
+uint32_t app_log_benchmark(void);
+#endif
+
+#endif /* APP_LOG_H_ */
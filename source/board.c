@@ -49,6 +49,7 @@
 #include "mesh_cfg.h"
 #include "mesh_app.h"
 #include "board.h"
+#include "mesh_lpn.h"
 #include "timers.h"
 #include <FreeRTOS.h>
 #include <task.h>
@@ -70,7 +71,7 @@
 #define BOARD_TASK_STACK_SIZE           (512u * 2u)
 
 #define BUTTON_INTERVAL_MS              (500u)   /* in milliseconds*/
-#define BUTTON_NUM_STEPS                (9u)
+#define BUTTON_DOUBLE_PRESS_MS          (300u)   /* second press window, in milliseconds */
 
 /*******************************************************************************
  * Function Prototypes
@@ -79,6 +80,13 @@ void board_led_init(void);
 void board_button_init(void);
 static void button_timer_callback(TimerHandle_t xTimer);
 static void button_interrupt_callback(void *handler_arg, cyhal_gpio_event_t event);
+static void board_button_sync_level(void);
+static void board_button_send_level(bool is_instant, bool is_final);
+static void board_button_toggle(void);
+static void board_button_action(const button_gesture_t *p_gesture);
+static void board_button_gesture(uint8_t button);
+static void board_button_flush_gesture(void);
+static void button_double_timer_callback(TimerHandle_t xTimer);
 
 /*******************************************************************************
 * Global Variables
@@ -101,6 +109,19 @@ cyhal_gpio_callback_data_t gpio_cb_data =
 };
 
 TimerHandle_t button_timer_handle;
+TimerHandle_t button_double_timer_handle;
+
+/* Short and double press gestures of each button */
+typedef struct
+{
+    button_gesture_t short_press;
+    button_gesture_t double_press;
+} button_gesture_cfg_t;
+
+static button_gesture_cfg_t button_gestures[USER_BUTTON_MAX] =
+{
+    [USER_BUTTON1] = { USER_BUTTON1_SHORT_PRESS, USER_BUTTON1_DOUBLE_PRESS },
+};
 
 /* Variables to keep the button timings. */
 uint8_t button_step_count = 0u;
@@ -110,6 +131,7 @@ uint32_t button_pushed_duration = 0u;
 
 static uint8_t previous_level = (BUTTON_NUM_STEPS - 1);
 static bool button_level_moving = false;
+static bool button_ramp_open = false;
 static bool button_short_press = false;
 
 static bool button_directon = true;
@@ -359,6 +381,15 @@ void board_task(void *pvParameters)
         CY_ASSERT(0u);
     }
 
+    button_double_timer_handle = xTimerCreate ("Button Double Timer", pdMS_TO_TICKS(BUTTON_DOUBLE_PRESS_MS),
+            pdFALSE, (void *)USER_BUTTON1, button_double_timer_callback);
+
+    if(NULL == button_double_timer_handle)
+    {
+        printf("Button double press timer initialization failed!\r\n");
+        CY_ASSERT(0u);
+    }
+
     for(;;)
      {
         /* Block till a notification is received. */
@@ -367,41 +398,42 @@ void board_task(void *pvParameters)
         switch(notify_value)
         {
         case BUTTON_PRESS:
-            xTimerStart(button_timer_handle, 0u);
+            xTimerChangePeriod(button_timer_handle, BUTTON_INTERVAL_MS, 0u);
+            mesh_app_adv_kick();
             button_short_press = true;
             break;
         case BUTTON_PRESSED:
             if(true == button_short_press)
             {
-                if(button_step_count == 0)
+                board_button_gesture(USER_BUTTON1);
+            }
+            else
+            {
+                button_level_moving = false;
+                xTimerStop(button_timer_handle, 0u);
+#ifdef ENABLE_LEVEL_MOVE
+                mesh_dimmer_move_stop();
+                if(button_step_count == (BUTTON_NUM_STEPS - 1))
+                {
+                    button_directon = false;
+                    previous_level = button_step_count;
+                }
+                else if(button_step_count == 0)
                 {
-                    button_step_count = previous_level;
-                    if(button_step_count == 0)
-                    {
-                        button_directon = true;
-                    }
-                    else if(button_step_count == (BUTTON_NUM_STEPS - 1))
-                    {
-                        button_directon = false;
-                    }
-                    else
-                    {
-                        button_directon = button_previous_direction;
-                    }
+                    button_directon = true;
+                    previous_level = (BUTTON_NUM_STEPS - 1);
                 }
                 else
                 {
                     previous_level = button_step_count;
-                    button_step_count = 0;
-                    button_previous_direction = button_directon;
-                    button_directon = true;
                 }
-                mesh_dimmer_set_level(true, true);
-            }
-            else
-            {
-                button_level_moving = false;
-                xTimerStop(button_timer_handle, 0u);
+#else
+                /* Released mid-ramp, send the reached step as the final level */
+                if(true == button_ramp_open)
+                {
+                    board_button_send_level(false, true);
+                }
+#endif
             }
             break;
          case BUTTON_LONGPRESSED:
@@ -409,13 +441,260 @@ void board_task(void *pvParameters)
              button_level_moving = false;
              printf("User button (SW2) long pressed: mesh core factory reset\r\n");
              // More than 10 seconds means factory reset
-             mesh_application_factory_reset();
+             mesh_app_factory_reset();
              break;
          }
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+        /* Poll timeout adapted by the button commands */
+        mesh_lpn_save();
+#endif
 
      }
 }
 
+/*******************************************************************************
+* Function Name: board_button_sync_level
+********************************************************************************
+* Summary:
+*   Take over the level last reported by the light before acting on the
+*   button, in case another controller has changed it.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+static void board_button_sync_level(void)
+{
+    if(!mesh_dimmer_sync_step())
+    {
+        return;
+    }
+
+    if(button_step_count == 0)
+    {
+        button_directon = true;
+    }
+    else
+    {
+        previous_level = button_step_count;
+        if(button_step_count == (BUTTON_NUM_STEPS - 1))
+        {
+            button_directon = false;
+        }
+    }
+}
+
+/*******************************************************************************
+* Function Name: board_button_send_level
+********************************************************************************
+* Summary:
+*   Send the level of the button step. A low power node also tracks the use
+*   of the switch for its poll timeout.
+*
+* Parameters:
+*   is_instant: instant flag
+*   is_final: final flag
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+static void board_button_send_level(bool is_instant, bool is_final)
+{
+    /* A ramp is open until its final level is sent */
+    button_ramp_open = !is_instant && !is_final;
+
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+    mesh_lpn_send_level(is_instant, is_final);
+#else
+    mesh_dimmer_set_level(is_instant, is_final);
+#endif
+}
+
+/*******************************************************************************
+* Function Name: board_button_toggle
+********************************************************************************
+* Summary:
+*   Toggle the light between off and the previous level.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+static void board_button_toggle(void)
+{
+    board_button_sync_level();
+    if(button_step_count == 0)
+    {
+        button_step_count = previous_level;
+        if(button_step_count == 0)
+        {
+            button_directon = true;
+        }
+        else if(button_step_count == (BUTTON_NUM_STEPS - 1))
+        {
+            button_directon = false;
+        }
+        else
+        {
+            button_directon = button_previous_direction;
+        }
+    }
+    else
+    {
+        previous_level = button_step_count;
+        button_step_count = 0;
+        button_previous_direction = button_directon;
+        button_directon = true;
+    }
+    board_button_send_level(true, true);
+}
+
+/*******************************************************************************
+* Function Name: board_button_action
+********************************************************************************
+* Summary:
+*   Perform the action of a button gesture.
+*
+* Parameters:
+*   p_gesture: gesture to perform
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+static void board_button_action(const button_gesture_t *p_gesture)
+{
+    switch(p_gesture->action)
+    {
+    case BUTTON_ACTION_TOGGLE:
+        board_button_toggle();
+        break;
+    case BUTTON_ACTION_SCENE_RECALL:
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+        mesh_lpn_send_scene(p_gesture->scene_number);
+#else
+        mesh_dimmer_scene_recall(p_gesture->scene_number);
+#endif
+        break;
+    default:
+        break;
+    }
+}
+
+/*******************************************************************************
+* Function Name: board_button_gesture
+********************************************************************************
+* Summary:
+*   Handle a short press of the button. Without a double press action the
+*   short press action is taken right away. Otherwise the short press action
+*   is taken when no second press follows within BUTTON_DOUBLE_PRESS_MS.
+*
+* Parameters:
+*   button: index of the button
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+static void board_button_gesture(uint8_t button)
+{
+    if(BUTTON_ACTION_NONE == button_gestures[button].double_press.action)
+    {
+        board_button_action(&button_gestures[button].short_press);
+    }
+    else if(pdFALSE != xTimerIsTimerActive(button_double_timer_handle))
+    {
+        xTimerStop(button_double_timer_handle, 0u);
+        board_button_action(&button_gestures[button].double_press);
+    }
+    else
+    {
+        xTimerStart(button_double_timer_handle, 0u);
+    }
+}
+
+/*******************************************************************************
+* Function Name: board_button_flush_gesture
+********************************************************************************
+* Summary:
+*   Take the pending short press action when the second press turns into a
+*   hold.
+*
+* Parameters:
+*   None
+*
+* Return:
+*   None
+*
+*******************************************************************************/
+static void board_button_flush_gesture(void)
+{
+    if(pdFALSE != xTimerIsTimerActive(button_double_timer_handle))
+    {
+        xTimerStop(button_double_timer_handle, 0u);
+        board_button_action(&button_gestures[USER_BUTTON1].short_press);
+    }
+}
+
+/*******************************************************************************
+* Function Name: board_button_set_gesture
+********************************************************************************
+* Summary:
+*   Change the action of a button gesture.
+*
+* Parameters:
+*   button: index of the button
+*   is_double_press: true to set the double press action, false for the
+*                    short press action
+*   p_gesture: new action
+*
+* Return:
+*   bool: true if the gesture is set
+*
+*******************************************************************************/
+bool board_button_set_gesture(uint8_t button, bool is_double_press, const button_gesture_t *p_gesture)
+{
+    if((button >= USER_BUTTON_MAX) || (NULL == p_gesture) ||
+       ((BUTTON_ACTION_SCENE_RECALL == p_gesture->action) && (0u == p_gesture->scene_number)))
+    {
+        return false;
+    }
+
+    if(is_double_press)
+    {
+        button_gestures[button].double_press = *p_gesture;
+    }
+    else
+    {
+        button_gestures[button].short_press = *p_gesture;
+    }
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: button_double_timer_callback
+ *******************************************************************************
+ * Summary:
+ *  Double press window expiry: no second press, take the short press action.
+ *
+ * Parameters:
+ *  TimerHandle_t xTimer : timer of the button
+ *
+ ******************************************************************************/
+static void button_double_timer_callback(TimerHandle_t xTimer)
+{
+    uint8_t button = (uint8_t)(uintptr_t)pvTimerGetTimerID(xTimer);
+
+    board_button_action(&button_gestures[button].short_press);
+}
+
 /*******************************************************************************
 * Function Name: button_interrupt_callback
 ********************************************************************************
@@ -464,7 +743,7 @@ static void button_interrupt_callback(void *handler_arg, cyhal_gpio_event_t even
  *******************************************************************************
  * Summary:
  *  Button timer callback. This function increment the steps level on button
- *  press and hold.
+ *  press and hold, or starts a level move when ENABLE_LEVEL_MOVE is defined.
  *
  * Parameters:
  *  TimerHandle_t xTimer (unused)
@@ -474,11 +753,30 @@ void button_timer_callback(TimerHandle_t xTimer)
 {
     bool value = cyhal_gpio_read(CYBSP_USER_BTN);
 
+#ifdef ENABLE_LEVEL_MOVE
+    /* A single level move is sent on hold, it is stopped on button release */
+    if((value == CYBSP_BTN_PRESSED) && (false == button_level_moving))
+    {
+        board_button_flush_gesture();
+        board_button_sync_level();
+        button_level_moving = true;
+        button_short_press = false;
+        mesh_dimmer_move_start(button_directon);
+    }
+    return;
+#endif
+
     if(value == CYBSP_BTN_PRESSED)
     {
+        if(false == button_level_moving)
+        {
+            board_button_flush_gesture();
+            board_button_sync_level();
+        }
         button_level_moving = true;
         button_short_press = false;
-        xTimerStartFromISR(button_timer_handle, 0u);
+        /* Steps repeat at the interval the network can deliver them */
+        xTimerChangePeriod(button_timer_handle, pdMS_TO_TICKS(mesh_dimmer_repeat_interval_ms()), 0u);
     }
 
     if(button_directon == true && button_level_moving == true)
@@ -489,12 +787,12 @@ void button_timer_callback(TimerHandle_t xTimer)
             xTimerStopFromISR(button_timer_handle, 0u);
             button_directon = false;
             previous_level = button_step_count;
-            mesh_dimmer_set_level(false, true);
+            board_button_send_level(false, true);
         }
         else
         {
             previous_level = button_step_count;
-            mesh_dimmer_set_level(false, false);
+            board_button_send_level(false, false);
         }
     }
     else if(button_directon == false && button_level_moving == true)
@@ -505,12 +803,12 @@ void button_timer_callback(TimerHandle_t xTimer)
             button_directon = true;
             xTimerStopFromISR(button_timer_handle, 0u);
             previous_level = (BUTTON_NUM_STEPS - 1);
-            mesh_dimmer_set_level(false, true);
+            board_button_send_level(false, true);
         }
         else
         {
             previous_level = button_step_count;
-            mesh_dimmer_set_level(false, false);
+            board_button_send_level(false, false);
         }
     }
 
@@ -49,6 +49,7 @@
 #include "stdint.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "dimmer_curve.h"
 
 /*******************************************************************************
 * Macros
@@ -56,6 +57,9 @@
 #define DELAY_MS(X)            cyhal_system_delay_ms(X)
 #define DELAY_US(X)            cyhal_system_delay_us(X)
 
+/* Number of dimming steps of the user button */
+#define BUTTON_NUM_STEPS       (DIMMER_NUM_STEPS)
+
 enum
 {
     LED_ON,
@@ -69,6 +73,12 @@ enum
     USER_LED_MAX
 };
 
+enum
+{
+    USER_BUTTON1,
+    USER_BUTTON_MAX
+};
+
 enum
 {
     BLINK_SLOW = 2u,
@@ -83,6 +93,33 @@ enum
     BUTTON_LONGPRESSED,
 };
 
+/* Action taken on a button gesture */
+typedef enum
+{
+    BUTTON_ACTION_NONE,
+    BUTTON_ACTION_TOGGLE,
+    BUTTON_ACTION_SCENE_RECALL,
+} button_action_t;
+
+typedef struct
+{
+    button_action_t action;
+    uint16_t scene_number;      /* scene recalled by BUTTON_ACTION_SCENE_RECALL */
+} button_gesture_t;
+
+#define BUTTON_GESTURE_NONE             { BUTTON_ACTION_NONE, 0u }
+#define BUTTON_GESTURE_TOGGLE           { BUTTON_ACTION_TOGGLE, 0u }
+#define BUTTON_GESTURE_SCENE(n)         { BUTTON_ACTION_SCENE_RECALL, (n) }
+
+/* Gestures of the user button. A short press is delayed by the double press
+ * window only when a double press action is configured. */
+#ifndef USER_BUTTON1_SHORT_PRESS
+#define USER_BUTTON1_SHORT_PRESS        BUTTON_GESTURE_TOGGLE
+#endif
+#ifndef USER_BUTTON1_DOUBLE_PRESS
+#define USER_BUTTON1_DOUBLE_PRESS       BUTTON_GESTURE_NONE
+#endif
+
 /*******************************************************************************
  * Function Prototypes
  ******************************************************************************/
@@ -91,6 +128,7 @@ void board_led_set_state(uint8_t index, bool value);
 void board_led_set_blink(uint8_t index, uint8_t value);
 void board_task(void *pvParameters);
 cy_rslt_t board_init(void);
+bool board_button_set_gesture(uint8_t button, bool is_double_press, const button_gesture_t *p_gesture);
 
 /*******************************************************************************
 * Global Variables
@@ -0,0 +1,215 @@
+/*******************************************************************************
+* File Name: boot_profile.c
+*
+* Description: This file contains the boot timeline recorder. The end of
+*              every boot phase is stamped with the core cycle counter, and
+*              the timeline is printed once the system is idle.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "cybsp.h"
+#include "cy_retarget_io.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "boot_profile.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define BOOT_PROFILE_TASK_STACK_SIZE    (512u)
+
+/*******************************************************************************
+ * Variables Definitions
+ ******************************************************************************/
+#define BOOT_PROFILE_PHASE_LABEL(name, label)   label,
+
+static const char *const boot_phase_labels[BOOT_PHASE_NUM] =
+{
+    BOOT_PROFILE_PHASES(BOOT_PROFILE_PHASE_LABEL)
+};
+
+static boot_profile_t boot_profile;
+
+/*******************************************************************************
+ * Function Name: boot_profile_start
+ *******************************************************************************
+ * Summary:
+ *  Start the DWT cycle counter from zero and mark the main entry. The
+ *  counter stops while the core is in deep sleep, so the phases after the
+ *  scheduler start are timed with the RTOS tick instead.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void boot_profile_start(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0u;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+
+    boot_profile.marked = 0u;
+    boot_profile_mark(BOOT_PHASE_MAIN);
+}
+
+/*******************************************************************************
+ * Function Name: boot_profile_phase_us
+ *******************************************************************************
+ * Summary:
+ *  Time from the main entry to the end of a boot phase. The phases up to the
+ *  scheduler start are timed with the cycle counter. The later ones add the
+ *  RTOS tick count, which starts at 0 with the scheduler and is kept up to
+ *  date across the tickless idle deep sleep, to the scheduler start time.
+ *
+ * Parameters:
+ *  boot_phase_t phase : boot phase
+ *
+ * Return:
+ *  uint32_t : time in microseconds, 0 if the phase is not marked
+ *
+ ******************************************************************************/
+uint32_t boot_profile_phase_us(boot_phase_t phase)
+{
+    uint32_t start_us;
+
+    if((phase >= BOOT_PHASE_NUM) || (0u == (boot_profile.marked & (1uL << phase))))
+    {
+        return 0u;
+    }
+    if(phase <= BOOT_PHASE_SCHEDULER_START)
+    {
+        return (uint32_t)(((uint64_t)boot_profile.cycles[phase] * 1000000u) / SystemCoreClock);
+    }
+
+    start_us = boot_profile_phase_us(BOOT_PHASE_SCHEDULER_START);
+    return start_us + (uint32_t)(((uint64_t)boot_profile.ticks[phase] * 1000000u) / configTICK_RATE_HZ);
+}
+
+/*******************************************************************************
+ * Function Name: boot_profile_get
+ *******************************************************************************
+ * Summary:
+ *  Get the boot timeline, for example for a boot time regression test.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  const boot_profile_t * : boot timeline
+ *
+ ******************************************************************************/
+const boot_profile_t *boot_profile_get(void)
+{
+    return &boot_profile;
+}
+
+/*******************************************************************************
+ * Function Name: boot_profile_report_task
+ *******************************************************************************
+ * Summary:
+ *  Print the boot timeline. The task runs at the idle priority, so the
+ *  report does not delay the rest of the start-up.
+ *
+ * Parameters:
+ *  void *pvParameters : not used
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void boot_profile_report_task(void *pvParameters)
+{
+    uint32_t previous_us = 0u;
+    uint32_t phase_us;
+
+    (void)pvParameters;
+
+    printf("Boot timeline:\n");
+    for(uint32_t phase = 0u; phase < BOOT_PHASE_NUM; phase++)
+    {
+        if(0u == (boot_profile.marked & (1uL << phase)))
+        {
+            continue;
+        }
+        phase_us = boot_profile_phase_us((boot_phase_t)phase);
+        printf("  %-26s %8ldus  %+9ldus  tick:%ld\n", boot_phase_labels[phase], phase_us,
+               (int32_t)(phase_us - previous_us), boot_profile.ticks[phase]);
+        previous_us = phase_us;
+    }
+
+    vTaskDelete(NULL);
+}
+
+/*******************************************************************************
+ * Function Name: boot_profile_mark
+ *******************************************************************************
+ * Summary:
+ *  Stamp the end of a boot phase. Only the first mark of a phase is kept.
+ *  The timeline is reported when the last phase is marked.
+ *
+ * Parameters:
+ *  boot_phase_t phase : boot phase that ended
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void boot_profile_mark(boot_phase_t phase)
+{
+    if((phase >= BOOT_PHASE_NUM) || (0u != (boot_profile.marked & (1uL << phase))))
+    {
+        return;
+    }
+
+    boot_profile.cycles[phase] = DWT->CYCCNT;
+    boot_profile.ticks[phase] = (taskSCHEDULER_NOT_STARTED == xTaskGetSchedulerState()) ?
+                                0u : (uint32_t)xTaskGetTickCount();
+    boot_profile.marked |= (1uL << phase);
+
+    if((BOOT_PHASE_NUM - 1u) == phase)
+    {
+        xTaskCreate(boot_profile_report_task, "Boot Profile", BOOT_PROFILE_TASK_STACK_SIZE,
+                    NULL, tskIDLE_PRIORITY, NULL);
+    }
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,103 @@
+/*******************************************************************************
+* File Name: boot_profile.h
+*
+* Description: This file is the public interface of boot_profile.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef BOOT_PROFILE_H_
+#define BOOT_PROFILE_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "stdint.h"
+#include "stdbool.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Boot phases, in boot order. Each phase is marked when it ends. The
+ * kv-store is mounted in parallel with the Bluetooth start-up, so it can end
+ * before or after the phases around it. */
+#define BOOT_PROFILE_PHASES(X) \
+    X(MAIN,                 "main entry") \
+    X(BSP_INIT,             "cybsp_init") \
+    X(BOARD_INIT,           "board_init") \
+    X(FLASH_INIT,           "flash_memory_init") \
+    X(BT_PLATFORM_CONFIG,   "cybt_platform_config_init") \
+    X(BT_STACK_INIT,        "wiced_bt_stack_init") \
+    X(HEAP_CREATE,          "wiced_bt_create_heap") \
+    X(SCHEDULER_START,      "scheduler start") \
+    X(FLASH_MOUNTED,        "kv-store mounted") \
+    X(BT_ENABLED,           "BTM_ENABLED_EVT") \
+    X(MESH_INIT_DONE,       "mesh_app_init_callback")
+
+#define BOOT_PROFILE_PHASE_ID(name, label)  BOOT_PHASE_##name,
+
+typedef enum
+{
+    BOOT_PROFILE_PHASES(BOOT_PROFILE_PHASE_ID)
+    BOOT_PHASE_NUM
+} boot_phase_t;
+
+/* Boot timeline: cycle counter and RTOS tick at the end of every phase. The
+ * tick times the phases after the scheduler start, the cycle counter stops in
+ * deep sleep. */
+typedef struct
+{
+    uint32_t cycles[BOOT_PHASE_NUM];
+    uint32_t ticks[BOOT_PHASE_NUM];
+    uint32_t marked;                            /* bit mask of the marked phases */
+} boot_profile_t;
+
+#ifdef ENABLE_BOOT_PROFILE
+#define BOOT_PROFILE_MARK(name)     boot_profile_mark(BOOT_PHASE_##name)
+#else
+#define BOOT_PROFILE_MARK(name)
+#endif
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void boot_profile_start(void);
+void boot_profile_mark(boot_phase_t phase);
+const boot_profile_t *boot_profile_get(void);
+uint32_t boot_profile_phase_us(boot_phase_t phase);
+
+#endif /* BOOT_PROFILE_H_ */
@@ -0,0 +1,187 @@
+/*******************************************************************************
+* File Name: dimmer_curve.h
+*
+* Description: This file contains the dimming curves generated at compile
+*              time for the switch dimmer level steps.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef DIMMER_CURVE_H_
+#define DIMMER_CURVE_H_
+
+/*******************************************************************************
+* Macros
+*******************************************************************************/
+/* Supported dimming curves */
+#define DIMMER_CURVE_LINEAR             (0)     /* Level proportional to the step */
+#define DIMMER_CURVE_CIE1931            (1)     /* CIE 1931 lightness, perceptually uniform steps */
+#define DIMMER_CURVE_GAMMA              (2)     /* Step raised to the power of DIMMER_GAMMA */
+
+/* Number of dimming steps, 2 to 64. It must be a plain decimal number as it is
+ * used to select the table generator. */
+#ifndef DIMMER_NUM_STEPS
+#define DIMMER_NUM_STEPS                9
+#endif
+
+/* Checked before the table generator expands, 1 step divides by zero in
+ * DIMMER_STEP_POS and more than 64 steps have no DIMMER_REPEAT macro */
+#if (DIMMER_NUM_STEPS < 2) || (DIMMER_NUM_STEPS > 64)
+#error "DIMMER_NUM_STEPS must be between 2 and 64"
+#endif
+
+#ifndef DIMMER_CURVE
+#define DIMMER_CURVE                    DIMMER_CURVE_LINEAR
+#endif
+
+/* Integer exponent of the gamma curve, 1 to 4 */
+#ifndef DIMMER_GAMMA
+#define DIMMER_GAMMA                    2
+#endif
+
+/* Position of the step in the range 0.0 to 1.0 */
+#define DIMMER_STEP_POS(i)              ((double)(i) / (double)(DIMMER_NUM_STEPS - 1))
+
+/* CIE 1931: L* = 100 * step, Y = L* / 903.3 below L* = 8, ((L* + 16) / 116)^3 above */
+#define DIMMER_CIE_L(i)                 (100.0 * DIMMER_STEP_POS(i))
+#define DIMMER_CIE_Y(i)                 ((DIMMER_CIE_L(i) <= 8.0) ? (DIMMER_CIE_L(i) / 903.3) :   \
+                                        (((DIMMER_CIE_L(i) + 16.0) / 116.0) *                     \
+                                         ((DIMMER_CIE_L(i) + 16.0) / 116.0) *                     \
+                                         ((DIMMER_CIE_L(i) + 16.0) / 116.0)))
+
+#define DIMMER_GAMMA_Y(i)               ((DIMMER_GAMMA == 1) ? DIMMER_STEP_POS(i) :               \
+                                         (DIMMER_GAMMA == 2) ? (DIMMER_STEP_POS(i) *              \
+                                                                DIMMER_STEP_POS(i)) :             \
+                                         (DIMMER_GAMMA == 3) ? (DIMMER_STEP_POS(i) *              \
+                                                                DIMMER_STEP_POS(i) *              \
+                                                                DIMMER_STEP_POS(i)) :             \
+                                                               (DIMMER_STEP_POS(i) *              \
+                                                                DIMMER_STEP_POS(i) *              \
+                                                                DIMMER_STEP_POS(i) *              \
+                                                                DIMMER_STEP_POS(i)))
+
+/* Relative light output of the step in the range 0.0 to 1.0 */
+#if (DIMMER_CURVE == DIMMER_CURVE_CIE1931)
+#define DIMMER_CURVE_Y(i)               DIMMER_CIE_Y(i)
+#elif (DIMMER_CURVE == DIMMER_CURVE_GAMMA)
+#define DIMMER_CURVE_Y(i)               DIMMER_GAMMA_Y(i)
+#else
+#define DIMMER_CURVE_Y(i)               DIMMER_STEP_POS(i)
+#endif
+
+/* Generic Level of the step, -32768 (off) to 32767 (full) */
+#define DIMMER_CURVE_RAW(i)             ((int32_t)(DIMMER_CURVE_Y(i) * 65536.0 + 0.5) - 32768)
+#define DIMMER_CURVE_LEVEL(i)           ((int16_t)((DIMMER_CURVE_RAW(i) > 32767) ? 32767 : DIMMER_CURVE_RAW(i)))
+
+/* Expand M(0), M(1) ... M(n - 1) */
+#define DIMMER_CAT_(a, b)               a##b
+#define DIMMER_CAT(a, b)                DIMMER_CAT_(a, b)
+#define DIMMER_REPEAT(n, M)             DIMMER_CAT(DIMMER_REPEAT_, n)(M)
+#define DIMMER_REPEAT_1(M)     M(0)
+#define DIMMER_REPEAT_2(M)     DIMMER_REPEAT_1(M), M(1)
+#define DIMMER_REPEAT_3(M)     DIMMER_REPEAT_2(M), M(2)
+#define DIMMER_REPEAT_4(M)     DIMMER_REPEAT_3(M), M(3)
+#define DIMMER_REPEAT_5(M)     DIMMER_REPEAT_4(M), M(4)
+#define DIMMER_REPEAT_6(M)     DIMMER_REPEAT_5(M), M(5)
+#define DIMMER_REPEAT_7(M)     DIMMER_REPEAT_6(M), M(6)
+#define DIMMER_REPEAT_8(M)     DIMMER_REPEAT_7(M), M(7)
+#define DIMMER_REPEAT_9(M)     DIMMER_REPEAT_8(M), M(8)
+#define DIMMER_REPEAT_10(M)     DIMMER_REPEAT_9(M), M(9)
+#define DIMMER_REPEAT_11(M)     DIMMER_REPEAT_10(M), M(10)
+#define DIMMER_REPEAT_12(M)     DIMMER_REPEAT_11(M), M(11)
+#define DIMMER_REPEAT_13(M)     DIMMER_REPEAT_12(M), M(12)
+#define DIMMER_REPEAT_14(M)     DIMMER_REPEAT_13(M), M(13)
+#define DIMMER_REPEAT_15(M)     DIMMER_REPEAT_14(M), M(14)
+#define DIMMER_REPEAT_16(M)     DIMMER_REPEAT_15(M), M(15)
+#define DIMMER_REPEAT_17(M)     DIMMER_REPEAT_16(M), M(16)
+#define DIMMER_REPEAT_18(M)     DIMMER_REPEAT_17(M), M(17)
+#define DIMMER_REPEAT_19(M)     DIMMER_REPEAT_18(M), M(18)
+#define DIMMER_REPEAT_20(M)     DIMMER_REPEAT_19(M), M(19)
+#define DIMMER_REPEAT_21(M)     DIMMER_REPEAT_20(M), M(20)
+#define DIMMER_REPEAT_22(M)     DIMMER_REPEAT_21(M), M(21)
+#define DIMMER_REPEAT_23(M)     DIMMER_REPEAT_22(M), M(22)
+#define DIMMER_REPEAT_24(M)     DIMMER_REPEAT_23(M), M(23)
+#define DIMMER_REPEAT_25(M)     DIMMER_REPEAT_24(M), M(24)
+#define DIMMER_REPEAT_26(M)     DIMMER_REPEAT_25(M), M(25)
+#define DIMMER_REPEAT_27(M)     DIMMER_REPEAT_26(M), M(26)
+#define DIMMER_REPEAT_28(M)     DIMMER_REPEAT_27(M), M(27)
+#define DIMMER_REPEAT_29(M)     DIMMER_REPEAT_28(M), M(28)
+#define DIMMER_REPEAT_30(M)     DIMMER_REPEAT_29(M), M(29)
+#define DIMMER_REPEAT_31(M)     DIMMER_REPEAT_30(M), M(30)
+#define DIMMER_REPEAT_32(M)     DIMMER_REPEAT_31(M), M(31)
+#define DIMMER_REPEAT_33(M)     DIMMER_REPEAT_32(M), M(32)
+#define DIMMER_REPEAT_34(M)     DIMMER_REPEAT_33(M), M(33)
+#define DIMMER_REPEAT_35(M)     DIMMER_REPEAT_34(M), M(34)
+#define DIMMER_REPEAT_36(M)     DIMMER_REPEAT_35(M), M(35)
+#define DIMMER_REPEAT_37(M)     DIMMER_REPEAT_36(M), M(36)
+#define DIMMER_REPEAT_38(M)     DIMMER_REPEAT_37(M), M(37)
+#define DIMMER_REPEAT_39(M)     DIMMER_REPEAT_38(M), M(38)
+#define DIMMER_REPEAT_40(M)     DIMMER_REPEAT_39(M), M(39)
+#define DIMMER_REPEAT_41(M)     DIMMER_REPEAT_40(M), M(40)
+#define DIMMER_REPEAT_42(M)     DIMMER_REPEAT_41(M), M(41)
+#define DIMMER_REPEAT_43(M)     DIMMER_REPEAT_42(M), M(42)
+#define DIMMER_REPEAT_44(M)     DIMMER_REPEAT_43(M), M(43)
+#define DIMMER_REPEAT_45(M)     DIMMER_REPEAT_44(M), M(44)
+#define DIMMER_REPEAT_46(M)     DIMMER_REPEAT_45(M), M(45)
+#define DIMMER_REPEAT_47(M)     DIMMER_REPEAT_46(M), M(46)
+#define DIMMER_REPEAT_48(M)     DIMMER_REPEAT_47(M), M(47)
+#define DIMMER_REPEAT_49(M)     DIMMER_REPEAT_48(M), M(48)
+#define DIMMER_REPEAT_50(M)     DIMMER_REPEAT_49(M), M(49)
+#define DIMMER_REPEAT_51(M)     DIMMER_REPEAT_50(M), M(50)
+#define DIMMER_REPEAT_52(M)     DIMMER_REPEAT_51(M), M(51)
+#define DIMMER_REPEAT_53(M)     DIMMER_REPEAT_52(M), M(52)
+#define DIMMER_REPEAT_54(M)     DIMMER_REPEAT_53(M), M(53)
+#define DIMMER_REPEAT_55(M)     DIMMER_REPEAT_54(M), M(54)
+#define DIMMER_REPEAT_56(M)     DIMMER_REPEAT_55(M), M(55)
+#define DIMMER_REPEAT_57(M)     DIMMER_REPEAT_56(M), M(56)
+#define DIMMER_REPEAT_58(M)     DIMMER_REPEAT_57(M), M(57)
+#define DIMMER_REPEAT_59(M)     DIMMER_REPEAT_58(M), M(58)
+#define DIMMER_REPEAT_60(M)     DIMMER_REPEAT_59(M), M(59)
+#define DIMMER_REPEAT_61(M)     DIMMER_REPEAT_60(M), M(60)
+#define DIMMER_REPEAT_62(M)     DIMMER_REPEAT_61(M), M(61)
+#define DIMMER_REPEAT_63(M)     DIMMER_REPEAT_62(M), M(62)
+#define DIMMER_REPEAT_64(M)     DIMMER_REPEAT_63(M), M(63)
+
+/* Initializer of the level table with DIMMER_NUM_STEPS entries, left empty
+ * after the range #error so that it is the only error reported */
+#if (DIMMER_NUM_STEPS < 2) || (DIMMER_NUM_STEPS > 64)
+#define DIMMER_CURVE_LEVEL_TABLE        0
+#else
+#define DIMMER_CURVE_LEVEL_TABLE        DIMMER_REPEAT(DIMMER_NUM_STEPS, DIMMER_CURVE_LEVEL)
+#endif
+
+#endif /* DIMMER_CURVE_H_ */
@@ -0,0 +1,195 @@
+/*******************************************************************************
+* File Name: dimmer_encode.c
+*
+* Description: This file contains the conversions of the dimmer level steps
+*              to Light Lightness and Light CTL states. The functions have
+*              no platform dependencies.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "dimmer_encode.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define DIMMER_LIGHTNESS_MAX             (65535u)
+
+/*******************************************************************************
+ * Function Name: dimmer_isqrt
+ *******************************************************************************
+ * Summary:
+ *  Integer square root, rounded down.
+ *
+ * Parameters:
+ *  uint32_t value : input value
+ *
+ * Return:
+ *  uint32_t : square root of value
+ *
+ ******************************************************************************/
+static uint32_t dimmer_isqrt(uint32_t value)
+{
+    uint32_t root = 0u;
+    uint32_t bit = 1uL << 30;
+
+    while(bit > value)
+    {
+        bit >>= 2;
+    }
+    while(0u != bit)
+    {
+        if(value >= (root + bit))
+        {
+            value -= root + bit;
+            root = (root >> 1) + bit;
+        }
+        else
+        {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+    return root;
+}
+
+/*******************************************************************************
+ * Function Name: dimmer_encode_lightness_actual
+ *******************************************************************************
+ * Summary:
+ *  Convert a Generic Level to the bound Light Lightness Actual state.
+ *
+ * Parameters:
+ *  int16_t level : Generic Level, -32768 to 32767
+ *
+ * Return:
+ *  uint16_t : Light Lightness Actual, 0 to 65535
+ *
+ ******************************************************************************/
+uint16_t dimmer_encode_lightness_actual(int16_t level)
+{
+    return (uint16_t)((int32_t)level + 32768);
+}
+
+/*******************************************************************************
+ * Function Name: dimmer_decode_lightness_actual
+ *******************************************************************************
+ * Summary:
+ *  Convert a Light Lightness Actual state to the bound Generic Level.
+ *
+ * Parameters:
+ *  uint16_t lightness_actual : Light Lightness Actual, 0 to 65535
+ *
+ * Return:
+ *  int16_t : Generic Level, -32768 to 32767
+ *
+ ******************************************************************************/
+int16_t dimmer_decode_lightness_actual(uint16_t lightness_actual)
+{
+    return (int16_t)((int32_t)lightness_actual - 32768);
+}
+
+/*******************************************************************************
+ * Function Name: dimmer_encode_lightness_linear
+ *******************************************************************************
+ * Summary:
+ *  Convert Light Lightness Actual to Light Lightness Linear,
+ *  Linear = ceil(65535 * (Actual / 65535)^2).
+ *
+ * Parameters:
+ *  uint16_t lightness_actual : Light Lightness Actual
+ *
+ * Return:
+ *  uint16_t : Light Lightness Linear
+ *
+ ******************************************************************************/
+uint16_t dimmer_encode_lightness_linear(uint16_t lightness_actual)
+{
+    uint32_t square = (uint32_t)lightness_actual * lightness_actual;
+
+    return (uint16_t)((square + (DIMMER_LIGHTNESS_MAX - 1u)) / DIMMER_LIGHTNESS_MAX);
+}
+
+/*******************************************************************************
+ * Function Name: dimmer_decode_lightness_linear
+ *******************************************************************************
+ * Summary:
+ *  Convert Light Lightness Linear to Light Lightness Actual,
+ *  Actual = 65535 * sqrt(Linear / 65535).
+ *
+ * Parameters:
+ *  uint16_t lightness_linear : Light Lightness Linear
+ *
+ * Return:
+ *  uint16_t : Light Lightness Actual
+ *
+ ******************************************************************************/
+uint16_t dimmer_decode_lightness_linear(uint16_t lightness_linear)
+{
+    return (uint16_t)dimmer_isqrt((uint32_t)lightness_linear * DIMMER_LIGHTNESS_MAX);
+}
+
+/*******************************************************************************
+ * Function Name: dimmer_encode_ctl_temperature
+ *******************************************************************************
+ * Summary:
+ *  Warm dimming: the colour temperature follows the lightness, from the
+ *  minimum (warmest) temperature at the lowest lightness to the maximum at
+ *  full lightness.
+ *
+ * Parameters:
+ *  uint16_t lightness_actual : Light Lightness Actual
+ *  uint16_t temperature_min : temperature at the lowest lightness in Kelvin
+ *  uint16_t temperature_max : temperature at full lightness in Kelvin
+ *
+ * Return:
+ *  uint16_t : Light CTL Temperature in Kelvin
+ *
+ ******************************************************************************/
+uint16_t dimmer_encode_ctl_temperature(uint16_t lightness_actual, uint16_t temperature_min,
+                                       uint16_t temperature_max)
+{
+    if(temperature_max <= temperature_min)
+    {
+        return temperature_min;
+    }
+    return (uint16_t)(temperature_min +
+            (((uint32_t)(temperature_max - temperature_min) * lightness_actual) / DIMMER_LIGHTNESS_MAX));
+}
+
+/* [] END OF FILE */
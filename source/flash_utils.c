@@ -48,6 +48,11 @@
 #include "wiced_memory.h"
 #include "mtb_kvstore.h"
 #include "stdlib.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "event_groups.h"
+#include "semphr.h"
+#include "boot_profile.h"
 #include "flash_utils.h"
 
 /*******************************************************************************
@@ -60,6 +65,13 @@
 #define QSPI_BUS_FREQ                       (50000000l)
 #define QSPI_GET_ERASE_SIZE                 (0u)
 
+/* The kv-store is mounted by a start-up task while the Bluetooth controller
+ * is brought up. The task busy-waits on the SMIF, so it runs below the
+ * Bluetooth tasks and fills the time they wait for the controller. */
+#define FLASH_TASK_PRIORITY                 (configMAX_PRIORITIES / 2u)
+#define FLASH_TASK_STACK_SIZE               (512u * 2u)
+#define FLASH_READY_BIT                     (1u << 0)
+
 /*******************************************************************************
  * Function Prototypes
  ******************************************************************************/
@@ -76,6 +88,23 @@ mtb_kvstore_t kv_store_obj;
 
 cy_stc_smif_context_t SMIFContext;
 
+/* Set once the kv-store mount is done, flash_mount_result tells whether it
+ * succeeded. The accesses fail while the kv-store is not mounted. */
+static EventGroupHandle_t flash_events = NULL;
+static volatile bool flash_ready = false;
+static cy_rslt_t flash_mount_result = CY_RSLT_SUCCESS;
+
+/* Held across a kv-store access, so a bulk erase and remount is never
+ * interleaved with the reads and writes of the Bluetooth stack */
+static SemaphoreHandle_t flash_mutex = NULL;
+
+/* Region of the kv-store, whole erase sectors */
+static uint32_t flash_start_addr = 0u;
+static uint32_t flash_length = 0u;
+
+/* Set by a bulk erase until the next write, no key can exist meanwhile */
+static bool flash_erased = false;
+
 /*Kvstore block device*/
 
 mtb_kvstore_bd_t block_device =
@@ -90,10 +119,10 @@ mtb_kvstore_bd_t block_device =
 };
 
 /*******************************************************************************
-* Function Name: flash_memory_init
+* Function Name: flash_memory_mount
 ********************************************************************************
 * Summary:
-* This function Initialize the flash memory.
+* This function initializes the SMIF and mounts the kv-store.
 *
 * Parameters:
 *  None
@@ -102,7 +131,7 @@ mtb_kvstore_bd_t block_device =
 *  cy_rslt_t : returns the result status.
 *
 *******************************************************************************/
-cy_rslt_t flash_memory_init(void)
+static cy_rslt_t flash_memory_mount(void)
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
     /*Define the space to be used Storage*/
@@ -117,7 +146,7 @@ cy_rslt_t flash_memory_init(void)
     if(CY_RSLT_SUCCESS != result)
     {
         printf("External flash initialization failed \r\n");
-        CY_ASSERT(0);
+        return result;
     }
 
     /*Define the space to be used for Bond Data Storage*/
@@ -133,6 +162,9 @@ cy_rslt_t flash_memory_init(void)
          start_addr = (smifMemConfigs[0]->deviceCfg->memSize - sector_size* 4);
      }
 
+    flash_start_addr = start_addr;
+    flash_length = length;
+
     /*Initialize kv-store library*/
     result = mtb_kvstore_init(&kv_store_obj, start_addr, length, &block_device);
 
@@ -140,7 +172,6 @@ cy_rslt_t flash_memory_init(void)
     if (CY_RSLT_SUCCESS !=  result)
     {
         printf("Kv-store initialization failed with error code = %x\r\n", (int)result);
-        CY_ASSERT(0);
     }
     else
     {
@@ -151,6 +182,108 @@ cy_rslt_t flash_memory_init(void)
 }
 
 
+/*******************************************************************************
+* Function Name: flash_memory_task
+********************************************************************************
+* Summary:
+* Start-up task mounting the kv-store, then releasing the flash accesses
+* waiting for it.
+*
+* Parameters:
+*  void *pvParameters : not used
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void flash_memory_task(void *pvParameters)
+{
+    (void)pvParameters;
+
+    if(!flash_ready)
+    {
+        flash_mount_result = flash_memory_mount();
+        BOOT_PROFILE_MARK(FLASH_MOUNTED);
+        flash_ready = true;
+    }
+    xEventGroupSetBits(flash_events, FLASH_READY_BIT);
+
+    vTaskDelete(NULL);
+}
+
+/*******************************************************************************
+* Function Name: flash_memory_wait_ready
+********************************************************************************
+* Summary:
+* Block until the kv-store mount is done. Once it is done this only checks a
+* flag.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  cy_rslt_t : result of the mount
+*
+*******************************************************************************/
+static cy_rslt_t flash_memory_wait_ready(void)
+{
+    if(flash_ready)
+    {
+        return flash_mount_result;
+    }
+    /* Nothing can be waited for before the scheduler runs, mount right away */
+    if(taskSCHEDULER_NOT_STARTED == xTaskGetSchedulerState())
+    {
+        flash_mount_result = flash_memory_mount();
+        flash_ready = true;
+        return flash_mount_result;
+    }
+    xEventGroupWaitBits(flash_events, FLASH_READY_BIT, pdFALSE, pdTRUE, portMAX_DELAY);
+    return flash_mount_result;
+}
+
+/*******************************************************************************
+* Function Name: flash_memory_init
+********************************************************************************
+* Summary:
+* This function starts the flash memory initialization. The kv-store is
+* mounted by a start-up task once the scheduler runs, the flash accesses
+* wait for it.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  cy_rslt_t : returns the result status.
+*
+*******************************************************************************/
+cy_rslt_t flash_memory_init(void)
+{
+    flash_events = xEventGroupCreate();
+    if(NULL == flash_events)
+    {
+        printf("Flash event group creation failed\r\n");
+        CY_ASSERT(0);
+    }
+
+    flash_mutex = xSemaphoreCreateMutex();
+    if(NULL == flash_mutex)
+    {
+        printf("Flash mutex creation failed\r\n");
+        CY_ASSERT(0);
+    }
+
+    if(pdPASS != xTaskCreate(flash_memory_task, "Flash Task", FLASH_TASK_STACK_SIZE,
+                             NULL, FLASH_TASK_PRIORITY, NULL))
+    {
+        printf("Failed to create flash task.\r\n");
+        CY_ASSERT(0);
+    }
+
+    return CY_RSLT_SUCCESS;
+}
+
+
 /*******************************************************************************
 * Function Name: flash_memory_read
 ********************************************************************************
@@ -171,15 +304,24 @@ uint16_t flash_memory_read(uint16_t config_item_id, uint32_t len, uint8_t* buf,
     cy_rslt_t result = CY_RSLT_SUCCESS;
     char key[]="0000";
 
+    if(CY_RSLT_SUCCESS != flash_memory_wait_ready())
+    {
+        *rslt = WICED_ERROR;
+        return 0;
+    }
+
     itoa(config_item_id, key, FLASH_KEY_BASE);
 
+    xSemaphoreTake(flash_mutex, portMAX_DELAY);
     if(CY_RSLT_SUCCESS != mtb_kvstore_key_exists(&kv_store_obj, key))
     {
+        xSemaphoreGive(flash_mutex);
         *rslt = WICED_SUCCESS;
         return 0;
     }
 
     result = mtb_kvstore_read(&kv_store_obj, key, (uint8_t*)buf, &len);
+    xSemaphoreGive(flash_mutex);
     if(CY_RSLT_SUCCESS != result)
     {
         printf("Flash read failed with error code : 0x%x\r\n", (int)result);
@@ -211,9 +353,18 @@ uint16_t flash_memory_write(uint16_t config_item_id, uint32_t len, uint8_t* buf,
     cy_rslt_t result = CY_RSLT_SUCCESS;
     char key[]="0000";
 
+    if(CY_RSLT_SUCCESS != flash_memory_wait_ready())
+    {
+        *rslt = WICED_ERROR;
+        return 0;
+    }
+
     itoa(config_item_id, key, FLASH_KEY_BASE);
 
+    xSemaphoreTake(flash_mutex, portMAX_DELAY);
+    flash_erased = false;
     result = mtb_kvstore_write(&kv_store_obj, key, (uint8_t*)buf, len);
+    xSemaphoreGive(flash_mutex);
     if(CY_RSLT_SUCCESS != result)
     {
         printf("Flash write failed with error code: 0x%x\r\n", (int)result);
@@ -243,9 +394,23 @@ cy_rslt_t flash_memory_delete(uint16_t config_item_id)
     cy_rslt_t result = CY_RSLT_SUCCESS;
     char key[FLASH_KEY_SIZE]={'\0'};
 
+    if(CY_RSLT_SUCCESS != flash_memory_wait_ready())
+    {
+        return WICED_ERROR;
+    }
+
     itoa(config_item_id, key, FLASH_KEY_BASE);
 
+    xSemaphoreTake(flash_mutex, portMAX_DELAY);
+    /* After a bulk erase the deletes of a factory reset have nothing to do */
+    if(flash_erased)
+    {
+        xSemaphoreGive(flash_mutex);
+        return WICED_SUCCESS;
+    }
+
     result = mtb_kvstore_delete(&kv_store_obj, key);
+    xSemaphoreGive(flash_mutex);
     if(CY_RSLT_SUCCESS != result)
     {
         printf("Flash delete failed with error code: 0x%x\r\n", (int)result);
@@ -272,7 +437,14 @@ cy_rslt_t flash_memory_reset(void)
 {
     cy_rslt_t result = CY_RSLT_SUCCESS;
 
+    if(CY_RSLT_SUCCESS != flash_memory_wait_ready())
+    {
+        return WICED_ERROR;
+    }
+
+    xSemaphoreTake(flash_mutex, portMAX_DELAY);
     result = mtb_kvstore_reset(&kv_store_obj);
+    xSemaphoreGive(flash_mutex);
     if(CY_RSLT_SUCCESS != result)
     {
         printf("Flash reset failed with error code: 0x%x\r\n", (int)result);
@@ -281,6 +453,62 @@ cy_rslt_t flash_memory_reset(void)
     return (result);
 }
 
+/*******************************************************************************
+* Function Name: flash_memory_erase_all
+********************************************************************************
+* Summary:
+* This function erases the whole kv-store region with one sector-aligned
+* erase, then mounts the empty kv-store again. It replaces deleting the keys
+* one by one on a factory reset.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  cy_rslt_t : returns the result status.
+*
+*******************************************************************************/
+cy_rslt_t flash_memory_erase_all(void)
+{
+    cy_rslt_t result = CY_RSLT_SUCCESS;
+
+    result = flash_memory_wait_ready();
+    if(CY_RSLT_SUCCESS != result)
+    {
+        return result;
+    }
+
+    /* The kv-store is unmounted until the end, no access may run meanwhile */
+    xSemaphoreTake(flash_mutex, portMAX_DELAY);
+    if(flash_erased)
+    {
+        xSemaphoreGive(flash_mutex);
+        return CY_RSLT_SUCCESS;
+    }
+
+    mtb_kvstore_deinit(&kv_store_obj);
+
+    result = bd_erase(NULL, flash_start_addr, flash_length);
+    if(CY_RSLT_SUCCESS != result)
+    {
+        printf("Flash erase failed with error code: 0x%x\r\n", (int)result);
+    }
+
+    /* Mount again even after a failed erase, the kv-store recovers the keys
+     * that are left */
+    flash_mount_result = mtb_kvstore_init(&kv_store_obj, flash_start_addr, flash_length, &block_device);
+    if(CY_RSLT_SUCCESS != flash_mount_result)
+    {
+        printf("Kv-store initialization failed after erase\r\n");
+        result = flash_mount_result;
+    }
+
+    flash_erased = (CY_RSLT_SUCCESS == result);
+    xSemaphoreGive(flash_mutex);
+    return result;
+}
+
+
 /*******************************************************************************
 * Function Name: bd_read_size
 ********************************************************************************
@@ -61,6 +61,7 @@ uint16_t flash_memory_write(uint16_t config_item_id, uint32_t len, uint8_t* buf,
 uint16_t flash_memory_read(uint16_t config_item_id, uint32_t len, uint8_t* buf, wiced_result_t *rslt);
 cy_rslt_t flash_memory_delete(uint16_t config_item_id);
 cy_rslt_t flash_memory_reset(void);
+cy_rslt_t flash_memory_erase_all(void);
 /*******************************************************************************
  * External Function Prototype
  ******************************************************************************/
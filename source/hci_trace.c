@@ -0,0 +1,463 @@
+/*******************************************************************************
+* File Name: hci_trace.c
+*
+* Description: This file contains the HCI trace filter for the spy log.
+*              The HCI packets passing the opcode and event bitmaps are
+*              queued in a RAM ring and sent to the debug UART by a low
+*              priority task, so the HCI path never waits for the UART.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#if defined(ENABLE_BT_SPY_LOG) && defined(ENABLE_HCI_TRACES)
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "cy_retarget_io.h"
+#include "cybt_debug_uart.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+#include "hci_trace.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#ifndef HCI_TRACE_RING_SIZE
+#define HCI_TRACE_RING_SIZE             (4096u) /* bytes, power of two */
+#endif
+#ifndef HCI_TRACE_MAX_LEN
+#define HCI_TRACE_MAX_LEN               (264u)  /* longest packet kept whole */
+#endif
+
+#define HCI_TRACE_TASK_PRIORITY         (tskIDLE_PRIORITY + 1u)
+#define HCI_TRACE_TASK_STACK_SIZE       (512u)
+#define HCI_TRACE_DRAIN_INTERVAL_MS     (10u)
+
+/* Record header: trace type and packet length */
+#define HCI_TRACE_HDR_LEN               (3u)
+
+/* Command opcodes are filtered per OGF and OCF below HCI_TRACE_OCF_NUM,
+ * vendor specific and other opcodes share one switch */
+#define HCI_TRACE_OGF_NUM               (9u)
+#define HCI_TRACE_OCF_NUM               (128u)
+#define HCI_TRACE_OPCODE_OGF(op)        ((uint16_t)(op) >> 10)
+#define HCI_TRACE_OPCODE_OCF(op)        ((uint16_t)(op) & 0x03FFu)
+
+#define HCI_EVENT_COMMAND_COMPLETE      (0x0Eu)
+#define HCI_EVENT_LE_META               (0x3Eu)
+
+#define BITMAP_WORDS(n)                 (((n) + 31u) / 32u)
+#define BITMAP_TEST(map, bit)           (0u != ((map)[(bit) >> 5] & (1uL << ((bit) & 31u))))
+#define BITMAP_SET(map, bit, on)        do { if(on) { (map)[(bit) >> 5] |= (1uL << ((bit) & 31u)); } \
+                                             else { (map)[(bit) >> 5] &= ~(1uL << ((bit) & 31u)); } } while(0)
+
+/*******************************************************************************
+ * Variables Definitions
+ ******************************************************************************/
+/* Filter tables. Command Complete and Command Status events follow the
+ * filter of the command they complete. */
+typedef struct
+{
+    uint32_t command[HCI_TRACE_OGF_NUM][BITMAP_WORDS(HCI_TRACE_OCF_NUM)];
+    bool other_commands;
+    uint32_t event[BITMAP_WORDS(256u)];
+    uint32_t le_event[BITMAP_WORDS(256u)];
+    bool acl;
+} hci_trace_filter_t;
+
+static hci_trace_filter_t hci_filter;
+
+static uint8_t hci_ring[HCI_TRACE_RING_SIZE];
+static uint32_t hci_ring_head = 0u;             /* written by the HCI path */
+static uint32_t hci_ring_tail = 0u;             /* written by the drain task */
+static hci_trace_stats_t hci_stats;
+
+static TaskHandle_t hci_trace_task_handle = NULL;
+
+_Static_assert((HCI_TRACE_RING_SIZE & (HCI_TRACE_RING_SIZE - 1u)) == 0u, "HCI_TRACE_RING_SIZE must be a power of two");
+
+/*******************************************************************************
+ * Function Name: hci_trace_command_passes
+ *******************************************************************************
+ * Summary:
+ *  Look up a command opcode in the filter.
+ *
+ * Parameters:
+ *  uint16_t opcode : HCI command opcode
+ *
+ * Return:
+ *  bool : true if the command is traced
+ *
+ ******************************************************************************/
+static bool hci_trace_command_passes(uint16_t opcode)
+{
+    uint16_t ogf = HCI_TRACE_OPCODE_OGF(opcode);
+    uint16_t ocf = HCI_TRACE_OPCODE_OCF(opcode);
+
+    if((ogf >= HCI_TRACE_OGF_NUM) || (ocf >= HCI_TRACE_OCF_NUM))
+    {
+        return hci_filter.other_commands;
+    }
+    return BITMAP_TEST(hci_filter.command[ogf], ocf);
+}
+
+/*******************************************************************************
+ * Function Name: hci_trace_passes
+ *******************************************************************************
+ * Summary:
+ *  Apply the filter tables to an HCI packet.
+ *
+ * Parameters:
+ *  wiced_bt_hci_trace_type_t type : trace type
+ *  uint16_t length : packet length
+ *  uint8_t* p_data : packet
+ *
+ * Return:
+ *  bool : true if the packet is traced
+ *
+ ******************************************************************************/
+static bool hci_trace_passes(wiced_bt_hci_trace_type_t type, uint16_t length, uint8_t* p_data)
+{
+    switch(type)
+    {
+    case HCI_TRACE_COMMAND:
+        return (length >= 2u) && hci_trace_command_passes((uint16_t)(p_data[0] | (p_data[1] << 8)));
+
+    case HCI_TRACE_EVENT:
+        if(length < 2u)
+        {
+            return false;
+        }
+        /* Command Complete follows the command filter. Command Status follows
+         * the event filter, so the extended advertising filter drops it */
+        if((HCI_EVENT_COMMAND_COMPLETE == p_data[0]) && (length >= 5u))
+        {
+            return hci_trace_command_passes((uint16_t)(p_data[3] | (p_data[4] << 8)));
+        }
+        if((HCI_EVENT_LE_META == p_data[0]) && (length >= 3u))
+        {
+            return BITMAP_TEST(hci_filter.le_event, p_data[2]);
+        }
+        return BITMAP_TEST(hci_filter.event, p_data[0]);
+
+    default:
+        return hci_filter.acl;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: hci_trace_cback
+ *******************************************************************************
+ * Summary:
+ *  HCI trace callback. A packet passing the filter is copied to the ring, or
+ *  counted as dropped if the ring is full. It never waits for the UART.
+ *
+ * Parameters:
+ *  wiced_bt_hci_trace_type_t type : trace type
+ *  uint16_t length : packet length
+ *  uint8_t* p_data : packet
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void hci_trace_cback(wiced_bt_hci_trace_type_t type, uint16_t length, uint8_t* p_data)
+{
+    uint32_t head;
+    uint32_t offset;
+    uint32_t first;
+    uint16_t rec_len;
+    uint8_t hdr[HCI_TRACE_HDR_LEN];
+
+    if(!hci_trace_passes(type, length, p_data))
+    {
+        hci_stats.filtered++;
+        return;
+    }
+
+    rec_len = length;
+    if(rec_len > HCI_TRACE_MAX_LEN)
+    {
+        rec_len = HCI_TRACE_MAX_LEN;
+        hci_stats.truncated++;
+    }
+
+    hdr[0] = (uint8_t)type;
+    hdr[1] = (uint8_t)rec_len;
+    hdr[2] = (uint8_t)(rec_len >> 8);
+
+    /* The HCI callbacks can come from the transmit and receive paths */
+    taskENTER_CRITICAL();
+    head = hci_ring_head;
+    if((HCI_TRACE_RING_SIZE - (head - __atomic_load_n(&hci_ring_tail, __ATOMIC_ACQUIRE))) <
+       (uint32_t)(HCI_TRACE_HDR_LEN + rec_len))
+    {
+        hci_stats.dropped++;
+        taskEXIT_CRITICAL();
+        return;
+    }
+    for(uint32_t i = 0u; i < HCI_TRACE_HDR_LEN; i++)
+    {
+        hci_ring[(head + i) & (HCI_TRACE_RING_SIZE - 1u)] = hdr[i];
+    }
+    offset = (head + HCI_TRACE_HDR_LEN) & (HCI_TRACE_RING_SIZE - 1u);
+    first = HCI_TRACE_RING_SIZE - offset;
+    first = (first > rec_len) ? rec_len : first;
+    memcpy(&hci_ring[offset], p_data, first);
+    memcpy(&hci_ring[0], &p_data[first], rec_len - first);
+    __atomic_store_n(&hci_ring_head, head + HCI_TRACE_HDR_LEN + rec_len, __ATOMIC_RELEASE);
+    hci_stats.traced++;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: hci_trace_task
+ *******************************************************************************
+ * Summary:
+ *  Send the queued packets to the debug UART.
+ *
+ * Parameters:
+ *  void *pvParameters : not used
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void hci_trace_task(void *pvParameters)
+{
+    static uint8_t packet[HCI_TRACE_MAX_LEN];
+    uint32_t tail;
+    uint32_t offset;
+    uint32_t first;
+    uint16_t rec_len;
+    wiced_bt_hci_trace_type_t type;
+
+    (void)pvParameters;
+
+    for(;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(HCI_TRACE_DRAIN_INTERVAL_MS));
+
+        tail = hci_ring_tail;
+        while(tail != __atomic_load_n(&hci_ring_head, __ATOMIC_ACQUIRE))
+        {
+            type = (wiced_bt_hci_trace_type_t)hci_ring[tail & (HCI_TRACE_RING_SIZE - 1u)];
+            rec_len = (uint16_t)(hci_ring[(tail + 1u) & (HCI_TRACE_RING_SIZE - 1u)] |
+                                 (hci_ring[(tail + 2u) & (HCI_TRACE_RING_SIZE - 1u)] << 8));
+
+            offset = (tail + HCI_TRACE_HDR_LEN) & (HCI_TRACE_RING_SIZE - 1u);
+            first = HCI_TRACE_RING_SIZE - offset;
+            first = (first > rec_len) ? rec_len : first;
+            memcpy(packet, &hci_ring[offset], first);
+            memcpy(&packet[first], &hci_ring[0], rec_len - first);
+
+            tail += HCI_TRACE_HDR_LEN + rec_len;
+            __atomic_store_n(&hci_ring_tail, tail, __ATOMIC_RELEASE);
+
+            cybt_debug_uart_send_hci_trace(type, rec_len, packet);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: hci_trace_filter_all
+ *******************************************************************************
+ * Summary:
+ *  Trace all HCI packets, or none.
+ *
+ * Parameters:
+ *  bool enable : true to trace all packets
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void hci_trace_filter_all(bool enable)
+{
+    memset(&hci_filter, enable ? 0xFF : 0x00, sizeof(hci_filter));
+    hci_filter.other_commands = enable;
+    hci_filter.acl = enable;
+}
+
+/*******************************************************************************
+ * Function Name: hci_trace_filter_command
+ *******************************************************************************
+ * Summary:
+ *  Trace a command, with its Command Complete event. Command Status events
+ *  are filtered by event code with hci_trace_filter_event(). Vendor specific
+ *  opcodes and OCFs above the table share one switch.
+ *
+ * Parameters:
+ *  uint16_t opcode : HCI command opcode
+ *  bool enable : true to trace the command
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void hci_trace_filter_command(uint16_t opcode, bool enable)
+{
+    uint16_t ogf = HCI_TRACE_OPCODE_OGF(opcode);
+    uint16_t ocf = HCI_TRACE_OPCODE_OCF(opcode);
+
+    if((ogf >= HCI_TRACE_OGF_NUM) || (ocf >= HCI_TRACE_OCF_NUM))
+    {
+        hci_filter.other_commands = enable;
+        return;
+    }
+    BITMAP_SET(hci_filter.command[ogf], ocf, enable);
+}
+
+/*******************************************************************************
+ * Function Name: hci_trace_filter_event
+ *******************************************************************************
+ * Summary:
+ *  Trace an event code, other than Command Complete, Command Status and LE
+ *  Meta events.
+ *
+ * Parameters:
+ *  uint8_t event_code : HCI event code
+ *  bool enable : true to trace the event
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void hci_trace_filter_event(uint8_t event_code, bool enable)
+{
+    BITMAP_SET(hci_filter.event, event_code, enable);
+}
+
+/*******************************************************************************
+ * Function Name: hci_trace_filter_le_event
+ *******************************************************************************
+ * Summary:
+ *  Trace an LE Meta subevent.
+ *
+ * Parameters:
+ *  uint8_t subevent_code : LE Meta subevent code
+ *  bool enable : true to trace the subevent
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void hci_trace_filter_le_event(uint8_t subevent_code, bool enable)
+{
+    BITMAP_SET(hci_filter.le_event, subevent_code, enable);
+}
+
+/*******************************************************************************
+ * Function Name: hci_trace_filter_acl
+ *******************************************************************************
+ * Summary:
+ *  Trace the ACL data packets.
+ *
+ * Parameters:
+ *  bool enable : true to trace ACL data
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void hci_trace_filter_acl(bool enable)
+{
+    hci_filter.acl = enable;
+}
+
+/*******************************************************************************
+ * Function Name: hci_trace_get_stats
+ *******************************************************************************
+ * Summary:
+ *  Get the trace counters.
+ *
+ * Parameters:
+ *  hci_trace_stats_t *p_stats : counters
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void hci_trace_get_stats(hci_trace_stats_t *p_stats)
+{
+    taskENTER_CRITICAL();
+    *p_stats = hci_stats;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: hci_trace_init
+ *******************************************************************************
+ * Summary:
+ *  Set the default filter and create the drain task. With
+ *  ENABLE_ONLY_EXT_ADV_SPY_LOG only the LE extended advertising set commands
+ *  and the advertising set terminated event are traced.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void hci_trace_init(void)
+{
+#ifdef ENABLE_ONLY_EXT_ADV_SPY_LOG
+    hci_trace_filter_all(false);
+    for(uint16_t opcode = 0x2035u; opcode <= 0x2039u; opcode++)
+    {
+        hci_trace_filter_command(opcode, true);
+    }
+    hci_trace_filter_le_event(0x12u, true);
+#else
+    hci_trace_filter_all(true);
+#endif
+
+    if(NULL == hci_trace_task_handle)
+    {
+        if(pdPASS != xTaskCreate(hci_trace_task, "HCI Trace Task", HCI_TRACE_TASK_STACK_SIZE, NULL,
+                                 HCI_TRACE_TASK_PRIORITY, &hci_trace_task_handle))
+        {
+            printf("Failed to create HCI trace task.\r\n");
+            CY_ASSERT(0u);
+        }
+    }
+}
+
+#endif /* ENABLE_BT_SPY_LOG && ENABLE_HCI_TRACES */
+
+/* [] END OF FILE */
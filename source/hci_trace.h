@@ -0,0 +1,77 @@
+/*******************************************************************************
+* File Name: hci_trace.h
+*
+* Description: This file is the public interface of hci_trace.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef HCI_TRACE_H_
+#define HCI_TRACE_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "stdint.h"
+#include "stdbool.h"
+#include "wiced_bt_dev.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Trace counters */
+typedef struct
+{
+    uint32_t traced;                            /* records queued for the UART */
+    uint32_t filtered;                          /* records rejected by the filter */
+    uint32_t dropped;                           /* records lost because the ring was full */
+    uint32_t truncated;                         /* records longer than HCI_TRACE_MAX_LEN */
+} hci_trace_stats_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void hci_trace_init(void);
+void hci_trace_cback(wiced_bt_hci_trace_type_t type, uint16_t length, uint8_t* p_data);
+void hci_trace_filter_all(bool enable);
+void hci_trace_filter_command(uint16_t opcode, bool enable);
+void hci_trace_filter_event(uint8_t event_code, bool enable);
+void hci_trace_filter_le_event(uint8_t subevent_code, bool enable);
+void hci_trace_filter_acl(bool enable);
+void hci_trace_get_stats(hci_trace_stats_t *p_stats);
+
+#endif /* HCI_TRACE_H_ */
@@ -61,6 +61,8 @@
 #include "mesh_app.h"
 #include "mesh_cfg.h"
 #include "mesh_application.h"
+#include "app_log.h"
+#include "boot_profile.h"
 
 /*******************************************************************************
 * Macros
@@ -105,8 +107,13 @@ int main()
     cy_rslt_t cy_result;
     wiced_result_t result;
 
+#ifdef ENABLE_BOOT_PROFILE
+    boot_profile_start();
+#endif
+
     /* Initialize the board support package */
     cy_result = cybsp_init();
+    BOOT_PROFILE_MARK(BSP_INIT);
 
     if(CY_RSLT_SUCCESS != cy_result)
     {
@@ -114,6 +121,7 @@ int main()
     }
 
     cy_result = board_init();
+    BOOT_PROFILE_MARK(BOARD_INIT);
 
     if(CY_RSLT_SUCCESS != cy_result)
     {
@@ -121,6 +129,9 @@ int main()
         CY_ASSERT(0);
     }
 
+    /* Log task formatting the deferred log records */
+    app_log_init();
+
     /* \x1b[2J\x1b[;H - ANSI ESC sequence to clear screen. */
     printf("\x1b[2J\x1b[;H");
     printf("===============================================================\n");
@@ -129,14 +140,17 @@ int main()
 
     if(CY_RSLT_SUCCESS == flash_memory_init())
     {
-        printf("Flash memory initialized! \r\n");
+        printf("Flash memory mount started! \r\n");
     }
+    BOOT_PROFILE_MARK(FLASH_INIT);
 
     /* Configure platform specific settings for the BT device */
     cybt_platform_config_init(&cybsp_bt_platform_cfg);
+    BOOT_PROFILE_MARK(BT_PLATFORM_CONFIG);
 
     /* Register call back and configuration with stack */
     result = wiced_bt_stack_init(mesh_management_callback, &wiced_bt_cfg_settings);
+    BOOT_PROFILE_MARK(BT_STACK_INIT);
 
     /* Check if stack initialization was successful */
     if(WICED_BT_SUCCESS == result)
@@ -150,6 +164,7 @@ int main()
     }
     /* Create a 10K heap, make it the default heap.  */
     p_mesh_heap = wiced_bt_create_heap("mesh_app", NULL, MESH_HEAP_SIZE, NULL, WICED_TRUE);
+    BOOT_PROFILE_MARK(HEAP_CREATE);
 
     if(NULL == p_mesh_heap)
     {
@@ -159,6 +174,8 @@ int main()
 
     mesh_app_setup_nvram_ids();
     
+    BOOT_PROFILE_MARK(SCHEDULER_START);
+
     /* Start the FreeRTOS scheduler */
     vTaskStartScheduler();
     
@@ -78,6 +78,12 @@
 #include "mesh_platform_utils.h"
 #include "mesh_cfg.h"
 #include "mesh_app.h"
+#include "app_log.h"
+#include "boot_profile.h"
+#include "hci_trace.h"
+#include "mesh_lpn.h"
+#include "mesh_friend.h"
+#include "mesh_hci_cmd.h"
 
 
 /*******************************************************************************
@@ -89,6 +95,15 @@
 // Number of fast power off to do factory reset
 #define MESH_APP_FAST_POWER_OFF_NUM                 5u
 
+// Marks a valid fast power off counter in the retained RAM
+#define MESH_APP_FAST_POWER_OFF_MAGIC               0x46504F43u
+
+// Marks a factory reset waiting for the first advert in the retained RAM
+#define MESH_APP_FACTORY_RESET_MAGIC                0x46525354u
+
+// Longest device name that fits in the scan response with its header
+#define MESH_APP_ADV_NAME_MAX_LEN                   29u
+
 /*******************************************************************************
  * Function Prototypes
  ******************************************************************************/
@@ -97,6 +112,15 @@ static void mesh_app_gatt_conn_status_cb(wiced_bt_gatt_connection_status_t *p_st
 static uint32_t mesh_app_proc_rx_cmd_cb(uint16_t opcode, uint8_t *p_data, uint32_t length);
 static void mesh_app_fast_power_off_timer_cb(TimerHandle_t timer_handle);
 static void mesh_app_fast_power_off_execute(void);
+static wiced_bool_t mesh_app_power_off_counter_valid(void);
+static void mesh_app_adv_state_changed(wiced_bt_ble_advert_mode_t mode);
+static void mesh_app_adv_restart_cb(WICED_TIMER_PARAM_TYPE arg);
+static void mesh_app_adv_sched_init(void);
+static uint32_t mesh_app_adv_duty_permille(void);
+static void mesh_app_proxy_link_relax_cb(WICED_TIMER_PARAM_TYPE arg);
+static void mesh_app_factory_reset_report(TickType_t now);
+static void mesh_app_proxy_link_update(wiced_bt_gatt_connection_status_t *pstatus);
+static void mesh_app_power_off_counter_set(uint8_t count);
 static void mesh_app_factory_reset_callback(void);
 
 /*******************************************************************************
@@ -113,6 +137,80 @@ TimerHandle_t power_off_timer;
 
 static wiced_bool_t last_provision_state = WICED_TRUE;
 
+/* Advertising payload of the scan response, built once */
+typedef struct
+{
+    uint8_t device_name[MESH_APP_ADV_NAME_MAX_LEN + 1u];  /* copy of the name in the elements */
+    uint16_t name_len;
+    uint16_t appearance;
+    uint8_t appearance_buf[2];
+    uint8_t num_elem;
+    wiced_bt_ble_advert_elem_t elem[2];
+} mesh_app_adv_cache_t;
+
+static mesh_app_adv_cache_t adv_cache;
+
+/* Restart schedule of the unprovisioned adverts. Within the fast window the
+ * adverts are restarted as soon as the stack stops them, then the restart is
+ * delayed with an exponential backoff. A button press opens a new window.
+ * The timer is only used from the stack context, a button press from the
+ * board task sets kick_pending and the backoff timer picks it up. */
+typedef struct
+{
+    wiced_timer_t timer;
+    bool is_init;
+    bool is_provisioned;
+    bool is_on;
+    bool is_discovered;
+    volatile bool kick_pending;                 /* window opened during a backoff */
+    uint32_t backoff_ms;
+    TickType_t restart_tick;                    /* end of the current backoff */
+    TickType_t window_tick;                     /* start of the fast window */
+    TickType_t on_tick;                         /* adverts on since */
+    uint32_t on_ms;                             /* adverts on time since the first window */
+    TickType_t start_tick;                      /* first window start */
+} mesh_app_adv_sched_t;
+
+static mesh_app_adv_sched_t adv_sched;
+
+/* Parameters of the proxy or PB-GATT connection */
+typedef struct
+{
+    wiced_timer_t timer;
+    bool is_init;
+    bool is_connected;
+    wiced_bt_device_address_t bd_addr;
+} mesh_app_proxy_link_t;
+
+static mesh_app_proxy_link_t proxy_link;
+
+/* Copy of the fast power off counter kept in RAM that is not initialized at
+ * start-up. It survives the resets that keep the SRAM powered, and saves the
+ * flash read on those resets. The counter in flash stays the reference: it is
+ * written on every count, so a power loss finds the same count. */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t count;
+    uint32_t check;
+} mesh_app_power_off_counter_t;
+
+CY_NOINIT static mesh_app_power_off_counter_t power_off_counter;
+
+/* Time spent in a factory reset before the reboot, kept in the retained RAM
+ * to report the reset to advertising time once the node advertises again */
+typedef struct
+{
+    uint32_t magic;
+    uint32_t elapsed_ms;
+    uint32_t check;
+} mesh_app_factory_reset_time_t;
+
+CY_NOINIT static mesh_app_factory_reset_time_t factory_reset_time;
+
+/* Start of the factory reset, 0 when none was started since boot */
+static TickType_t factory_reset_tick = 0u;
+
 /*
  * Mesh application library will call into application functions if provided
  * by the application.
@@ -125,7 +223,11 @@ wiced_bt_mesh_app_func_table_t wiced_bt_mesh_app_func_table =
     NULL,                                   // attention processing
     NULL,                                   // notify period set
     mesh_app_proc_rx_cmd_cb,                   // WICED HCI command
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+    mesh_lpn_sleep,                         // LPN sleep
+#else
     NULL,                                   // LPN sleep
+#endif
     mesh_app_factory_reset_callback         // factory reset
 };
 
@@ -133,6 +235,43 @@ wiced_bt_mesh_app_func_table_t wiced_bt_mesh_app_func_table =
 * Function Definitions
 ******************************************************************************/
 
+/*******************************************************************************
+* Function Name: mesh_app_power_off_counter_valid
+********************************************************************************
+* Summary: Check whether the retained fast power off counter survived the reset.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  wiced_bool_t : WICED_TRUE if the retained counter can be used
+*
+*******************************************************************************/
+static wiced_bool_t mesh_app_power_off_counter_valid(void)
+{
+    return (wiced_bool_t)((MESH_APP_FAST_POWER_OFF_MAGIC == power_off_counter.magic) &&
+            (~(power_off_counter.magic ^ power_off_counter.count) == power_off_counter.check));
+}
+
+/*******************************************************************************
+* Function Name: mesh_app_power_off_counter_set
+********************************************************************************
+* Summary: Store the fast power off counter in the retained RAM.
+*
+* Parameters:
+*  count : number of fast power offs
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void mesh_app_power_off_counter_set(uint8_t count)
+{
+    power_off_counter.magic = MESH_APP_FAST_POWER_OFF_MAGIC;
+    power_off_counter.count = count;
+    power_off_counter.check = ~(power_off_counter.magic ^ count);
+}
+
 /*******************************************************************************
 * Function Name: mesh_app_fast_power_off_timer_cb
 ********************************************************************************
@@ -152,6 +291,7 @@ void mesh_app_fast_power_off_timer_cb(TimerHandle_t timer_handle)
     uint16_t        id = mesh_application_get_nvram_id_app_start();
     printf("mesh power reset: timeout\n");
     flash_memory_delete(id);
+    mesh_app_power_off_counter_set(0u);
 }
 
 
@@ -175,26 +315,37 @@ void mesh_app_fast_power_off_execute(void)
 
     // Get the first usable by application NVRAM Identifier
     id = mesh_application_get_nvram_id_app_start();
-    /* read counter from the NVRAM and increment it.
-     * If it doesn't exist then reset counter     */
 
-    if (sizeof(cnt) !=  flash_memory_read(id, sizeof(cnt), &cnt, &rslt))
+    /* Use the retained copy if the RAM kept its content. Otherwise read
+     * counter from the NVRAM and increment it. If it doesn't exist then
+     * reset counter */
+    if (mesh_app_power_off_counter_valid())
+    {
+        cnt = (uint8_t)power_off_counter.count + 1u;
+    }
+    else if (sizeof(cnt) !=  flash_memory_read(id, sizeof(cnt), &cnt, &rslt))
     {
         printf("mesh power reset: read flash failed.\r\n");
         cnt = 1;
     }
     else
+    {
         cnt++;
+    }
     /* If counter has reached configured limit then delete counter NVRAM ID and
      * do factory reset */
     if (cnt >= MESH_APP_FAST_POWER_OFF_NUM)
     {
         printf("mesh power reset: user requested factory reset\n");
         flash_memory_delete(id);
-        mesh_application_factory_reset(); /* Factory reset the mesh application */
+        mesh_app_power_off_counter_set(0u);
+        mesh_app_factory_reset(); /* Factory reset the mesh application */
+        return;
     }
-    /* Write counter to NVRAM and start 5 sec timer to reset it if it expires */
-    else if (sizeof(cnt) != flash_memory_write(id, sizeof(cnt), &cnt, &rslt))
+
+    /* The count is always written to flash, a power loss may follow */
+    mesh_app_power_off_counter_set(cnt);
+    if (sizeof(cnt) != flash_memory_write(id, sizeof(cnt), &cnt, &rslt))
     {
         printf("mesh power reset: write flash failed. \r\n");
     }
@@ -229,11 +380,8 @@ void mesh_app_fast_power_off_execute(void)
 void mesh_app_init_callback(wiced_bool_t is_provisioned)
 {
 
-    /* Enable or disable Mesh traces from makefile*/
-#if(WICED_BT_MESH_TRACE_ENABLE)
-    wiced_bt_mesh_models_set_trace_level(WICED_BT_MESH_CORE_TRACE_DEBUG);
-    wiced_bt_mesh_core_set_trace_level(WICED_BT_MESH_CORE_TRACE_FID_ALL, WICED_BT_MESH_CORE_TRACE_DEBUG);
-#endif
+    /* Mesh traces are built in from makefile, their levels change at run time */
+    app_log_apply_mesh_levels();
 
     printf("Mesh provision status:%d\r\n" , is_provisioned);
 
@@ -252,6 +400,9 @@ void mesh_app_init_callback(wiced_bool_t is_provisioned)
     {
         (void) mesh_app_adv_config((uint8_t*)MESH_DEVICE_NAME, MESH_DEVICE_APPERANCE);
     }
+    adv_sched.is_provisioned = (bool)is_provisioned;
+    mesh_app_adv_sched_init();
+    mesh_app_adv_kick();
 
     /* Set the PWM output frequency and duty cycle */
     if(!is_provisioned){
@@ -290,32 +441,10 @@ void mesh_app_init_callback(wiced_bool_t is_provisioned)
 #endif
     mesh_level_client_model_init(is_provisioned);
     printf("Mesh module initialization Done!\r\n");
+    BOOT_PROFILE_MARK(MESH_INIT_DONE);
 }
 
 
-#if defined(ENABLE_BT_SPY_LOG) && defined(ENABLE_HCI_TRACES)
-void hci_trace_cback(wiced_bt_hci_trace_type_t type, uint16_t length, uint8_t* p_data)
-{
-#ifdef ENABLE_ONLY_EXT_ADV_SPY_LOG
-    if (type == HCI_TRACE_COMMAND)
-    {
-        if (p_data[0] < 0x35 || p_data[0] > 0x39 || p_data[1] != 0x20)
-            return;
-    }
-    else if (type == HCI_TRACE_EVENT)
-    {
-        if (p_data[0] != 0xe || p_data[3] < 0x35 || p_data[3] > 0x39 || p_data[4] != 0x20)
-            if (p_data[0] != 0x3e || p_data[1] != 0x6 || p_data[2] != 0x12)
-                return;
-    }
-    else
-        return;
-#endif
-    cybt_debug_uart_send_hci_trace(type, length, p_data);
-}
-#endif
-
-
 /*******************************************************************************
 * Function Name: mesh_management_callback
 ********************************************************************************
@@ -339,11 +468,21 @@ wiced_result_t mesh_management_callback(wiced_bt_management_evt_t event,
     {
         /* Bluetooth stack enabled */
     case BTM_ENABLED_EVT:
+        BOOT_PROFILE_MARK(BT_ENABLED);
 
 #if defined(ENABLE_BT_SPY_LOG) && defined(ENABLE_HCI_TRACES)
+    hci_trace_init();
     wiced_bt_dev_register_hci_trace(hci_trace_cback);
 #endif
 
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+        /* The poll timeout is requested by the mesh core, restore it first */
+        mesh_lpn_init();
+#else
+        /* The mesh core allocates the friend cache with the sizes in mesh_config */
+        mesh_friend_cache_init();
+#endif
+
 #ifdef _DEB_DELAY_START_SEC   /* Mesh Application to start with defined delay */
         mesh_delay_start_init();
 #else
@@ -360,21 +499,32 @@ wiced_result_t mesh_management_callback(wiced_bt_management_evt_t event,
 
     case BTM_BLE_ADVERT_STATE_CHANGED_EVT:
         p_mode = &p_event_data->ble_advert_state_changed;
-        printf("Advertisement State Changed:%d\n", *p_mode);
-        if (*p_mode == BTM_BLE_ADVERT_OFF)
+        APP_LOG1(ADV_STATE, *p_mode);
+        mesh_app_adv_state_changed(*p_mode);
+        break;
+
+    case BTM_BLE_CONNECTION_PARAM_UPDATE:
+        if (WICED_BT_SUCCESS == p_event_data->ble_connection_param_update.status)
         {
-            printf("BT adv stopped\r\n");
-            // On failed attempt to connect FW stops all connectable adverts.
-            // If we disconnected then notify core to restart them
-            if (!mesh_app_gatt_is_connected())
-            {
-                wiced_bt_mesh_core_connection_status(0u, WICED_FALSE, 0, 20);
-            }
+            uint32_t interval_us = (uint32_t)p_event_data->ble_connection_param_update.conn_interval * 1250u;
+
+            /* Ceiling of the proxy PDUs that fit in one packet,
+             * MESH_PROXY_PKTS_PER_EVENT of them at every connection event.
+             * The PDUs are handled in the mesh library and are not counted
+             * here, so the actual throughput is not measured */
+            APP_LOG4(CONN_PARAMS, interval_us, p_event_data->ble_connection_param_update.conn_latency,
+                     p_event_data->ble_connection_param_update.supervision_timeout * 10u,
+                     (0u == interval_us) ? 0u : ((MESH_PROXY_PKTS_PER_EVENT * 1000000u) / interval_us));
         }
         break;
 
+    case BTM_BLE_DATA_LENGTH_UPDATE_EVENT:
+        APP_LOG2(DATA_LENGTH, p_event_data->ble_data_length_update.max_tx_octets,
+                 p_event_data->ble_data_length_update.max_rx_octets);
+        break;
+
     case BTM_BLE_SCAN_STATE_CHANGED_EVT:
-        printf("BT scan state change:%d\r\n", p_event_data->ble_scan_state_changed);
+        APP_LOG1(SCAN_STATE, p_event_data->ble_scan_state_changed);
         break;
 
     case  BTM_PAIRED_DEVICE_LINK_KEYS_REQUEST_EVT:
@@ -392,7 +542,8 @@ wiced_result_t mesh_management_callback(wiced_bt_management_evt_t event,
 * Function Name: mesh_app_proc_rx_cmd_cb
 ********************************************************************************
 * Summary: In 2 chip solutions MCU can send the HCI command that light state has
-*          changed.
+*          changed. The switch commands, see mesh_hci_cmd.h, are dispatched
+*          from the received frame without copying it.
 *
 * Parameters:
 *  opcode : HCI Command Opcode
@@ -405,6 +556,11 @@ wiced_result_t mesh_management_callback(wiced_bt_management_evt_t event,
 *******************************************************************************/
 uint32_t mesh_app_proc_rx_cmd_cb(uint16_t opcode, uint8_t *p_data, uint32_t length)
 {
+    if(mesh_hci_cmd_is_app_opcode(opcode))
+    {
+        mesh_hci_cmd_handle(opcode, p_data, length);
+        return WICED_TRUE;
+    }
 
     printf("mesh app proc rx cmd opcode 0x%02x\n", opcode);
 
@@ -415,7 +571,10 @@ uint32_t mesh_app_proc_rx_cmd_cb(uint16_t opcode, uint8_t *p_data, uint32_t leng
 /*******************************************************************************
 * Function Name: mesh_app_factory_reset_callback
 ********************************************************************************
-* Summary: Callback function for mesh factory reset
+* Summary: Callback function for mesh factory reset. The time spent so far is
+*          kept for the reset to advertising report. The bulk erase is only
+*          done by the local resets in mesh_app_factory_reset(); a Node Reset
+*          from the provisioner leaves the records to the mesh library.
 *
 * Parameters:
 *  None
@@ -426,7 +585,146 @@ uint32_t mesh_app_proc_rx_cmd_cb(uint16_t opcode, uint8_t *p_data, uint32_t leng
 *******************************************************************************/
 void mesh_app_factory_reset_callback(void)
 {
-    /*TODO on factory reset*/
+    /* A Node Reset from the provisioner does not go through
+     * mesh_app_factory_reset(). It runs inside the mesh library, which may
+     * already have deleted records, so no bulk erase is started from here */
+    if (0u == factory_reset_tick)
+    {
+        factory_reset_tick = xTaskGetTickCount();
+    }
+
+    factory_reset_time.magic = MESH_APP_FACTORY_RESET_MAGIC;
+    factory_reset_time.elapsed_ms = (uint32_t)(xTaskGetTickCount() - factory_reset_tick) * portTICK_PERIOD_MS;
+    factory_reset_time.check = ~(factory_reset_time.magic ^ factory_reset_time.elapsed_ms);
+}
+
+/*******************************************************************************
+* Function Name: mesh_app_factory_reset
+********************************************************************************
+* Summary: Factory reset the node. The whole kv-store region is erased with
+*          one bulk erase first, so the mesh library finds no record left to
+*          delete one by one. Every record in the region goes, including the
+*          application ones.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void mesh_app_factory_reset(void)
+{
+    TickType_t erase_tick;
+
+    factory_reset_tick = xTaskGetTickCount();
+    (void)flash_memory_erase_all();
+    erase_tick = xTaskGetTickCount();
+    printf("mesh factory reset: flash erased in %ldms\n",
+           (uint32_t)(erase_tick - factory_reset_tick) * portTICK_PERIOD_MS);
+
+    mesh_application_factory_reset();
+}
+
+/*******************************************************************************
+* Function Name: mesh_app_factory_reset_report
+********************************************************************************
+* Summary: Print the reset to advertising time when the first advert after a
+*          factory reset starts. After a reboot the time before the reboot is
+*          added to the time since the scheduler started; the ROM boot is
+*          not counted.
+*
+* Parameters:
+*  now : tick of the advert start
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void mesh_app_factory_reset_report(TickType_t now)
+{
+    uint32_t total_ms;
+
+    if ((MESH_APP_FACTORY_RESET_MAGIC != factory_reset_time.magic) ||
+        (~(factory_reset_time.magic ^ factory_reset_time.elapsed_ms) != factory_reset_time.check))
+    {
+        return;
+    }
+
+    if (0u != factory_reset_tick)
+    {
+        /* The node was not rebooted */
+        total_ms = (uint32_t)(now - factory_reset_tick) * portTICK_PERIOD_MS;
+    }
+    else
+    {
+        total_ms = factory_reset_time.elapsed_ms + (uint32_t)now * portTICK_PERIOD_MS;
+    }
+    factory_reset_time.magic = 0u;
+    factory_reset_tick = 0u;
+
+    APP_LOG1(FACTORY_RESET_ADV, total_ms);
+}
+
+/*******************************************************************************
+* Function Name: mesh_app_proxy_link_relax_cb
+********************************************************************************
+* Summary: End of the burst window: request the idle connection parameters.
+*
+* Parameters:
+*  arg : not used
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void mesh_app_proxy_link_relax_cb(WICED_TIMER_PARAM_TYPE arg)
+{
+    (void)arg;
+
+    /* PB-GATT provisioning and the configuration that follows keep the link fast */
+    if (!proxy_link.is_connected || !adv_sched.is_provisioned)
+    {
+        return;
+    }
+    wiced_bt_l2cap_update_ble_conn_params(proxy_link.bd_addr, MESH_PROXY_IDLE_INTERVAL_MIN,
+            MESH_PROXY_IDLE_INTERVAL_MAX, MESH_PROXY_IDLE_LATENCY, MESH_PROXY_SUPERVISION_TIMEOUT);
+}
+
+/*******************************************************************************
+* Function Name: mesh_app_proxy_link_update
+********************************************************************************
+* Summary: On a new proxy or PB-GATT connection, enable the LE Data Length
+*            Extension and request the fast connection parameters for the
+*            burst window.
+*
+* Parameters:
+*  pstatus : GATT connection status
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void mesh_app_proxy_link_update(wiced_bt_gatt_connection_status_t *pstatus)
+{
+    if (!proxy_link.is_init)
+    {
+        wiced_init_timer(&proxy_link.timer, mesh_app_proxy_link_relax_cb, 0, WICED_MILLI_SECONDS_TIMER);
+        proxy_link.is_init = true;
+    }
+
+    proxy_link.is_connected = (bool)pstatus->connected;
+    if (!proxy_link.is_connected)
+    {
+        wiced_stop_timer(&proxy_link.timer);
+        return;
+    }
+
+    memcpy(proxy_link.bd_addr, pstatus->bd_addr, sizeof(wiced_bt_device_address_t));
+    wiced_bt_ble_set_data_packet_length(proxy_link.bd_addr, MESH_PROXY_TX_OCTETS, MESH_PROXY_TX_TIME_US);
+    wiced_bt_l2cap_update_ble_conn_params(proxy_link.bd_addr, MESH_PROXY_FAST_INTERVAL_MIN,
+            MESH_PROXY_FAST_INTERVAL_MAX, 0u, MESH_PROXY_SUPERVISION_TIMEOUT);
+    wiced_start_timer(&proxy_link.timer, MESH_PROXY_BURST_MS);
 }
 
 /*******************************************************************************
@@ -443,7 +741,18 @@ void mesh_app_factory_reset_callback(void)
 *******************************************************************************/
 void mesh_app_gatt_conn_status_cb(wiced_bt_gatt_connection_status_t *pstatus)
 {
-    printf( "mesh app GATT connected status %d, id:%d \n", pstatus->connected,pstatus->conn_id);
+    APP_LOG2(GATT_CONNECTED, pstatus->connected, pstatus->conn_id);
+    mesh_app_proxy_link_update(pstatus);
+
+    /* A connection to an unprovisioned node is the provisioner finding it */
+    if (pstatus->connected && !adv_sched.is_provisioned && !adv_sched.is_discovered)
+    {
+        uint32_t duty = mesh_app_adv_duty_permille();
+
+        adv_sched.is_discovered = true;
+        APP_LOG3(ADV_DISCOVERED, (uint32_t)(xTaskGetTickCount() - adv_sched.window_tick) * portTICK_PERIOD_MS,
+                 duty / 10u, duty % 10u);
+    }
 }
 
 /*******************************************************************************
@@ -463,32 +772,45 @@ void mesh_app_gatt_conn_status_cb(wiced_bt_gatt_connection_status_t *pstatus)
 wiced_bool_t mesh_app_adv_config(uint8_t *device_name, uint16_t appearance)
 {
     cy_rslt_t result;
-    wiced_bt_ble_advert_elem_t  adv_elem[3];
-    uint8_t                     buf[2];
-    uint8_t                     num_elem = 0;
+    uint16_t name_len;
 
     if(NULL == device_name)
         return WICED_FALSE;
 
-    /* Adv Data is fixed. Spec allows to put URI, Name, Appearance and Tx Power
-    in the Scan Response Data. */
-
-    wiced_bt_cfg_settings.device_name = (uint8_t *)device_name;
-    wiced_bt_cfg_ble.appearance = (wiced_bt_gatt_appearance_t)appearance;
+    name_len = (uint16_t)strnlen((const char*)device_name, MESH_APP_ADV_NAME_MAX_LEN);
 
-    adv_elem[num_elem].advert_type = BTM_BLE_ADVERT_TYPE_NAME_COMPLETE;
-    adv_elem[num_elem].len = (uint16_t)strlen((const char*)wiced_bt_cfg_settings.device_name);
-    adv_elem[num_elem].p_data = wiced_bt_cfg_settings.device_name;
-    num_elem++;
-
-    adv_elem[num_elem].advert_type = BTM_BLE_ADVERT_TYPE_APPEARANCE;
-    adv_elem[num_elem].len = 2;
-    buf[0] = (uint8_t)wiced_bt_cfg_settings.p_ble_cfg->appearance;
-    buf[1] = (uint8_t)(wiced_bt_cfg_settings.p_ble_cfg->appearance >> 8);
-    adv_elem[num_elem].p_data = buf;
-    num_elem++;
+    /* Adv Data is fixed. Spec allows to put URI, Name, Appearance and Tx Power
+    in the Scan Response Data. The elements are only rebuilt when the name or
+    the appearance changes. The name is compared by contents, the caller may
+    reuse its buffer for a new name. */
+    if((adv_cache.name_len != name_len) ||
+       (0 != memcmp(adv_cache.device_name, device_name, name_len)) ||
+       (adv_cache.appearance != appearance) || (0u == adv_cache.num_elem))
+    {
+        memcpy(adv_cache.device_name, device_name, name_len);
+        adv_cache.device_name[name_len] = 0u;
+        adv_cache.name_len = name_len;
+
+        wiced_bt_cfg_settings.device_name = adv_cache.device_name;
+        wiced_bt_cfg_ble.appearance = (wiced_bt_gatt_appearance_t)appearance;
+
+        adv_cache.appearance = appearance;
+        adv_cache.num_elem = 0u;
+
+        adv_cache.elem[adv_cache.num_elem].advert_type = BTM_BLE_ADVERT_TYPE_NAME_COMPLETE;
+        adv_cache.elem[adv_cache.num_elem].len = name_len;
+        adv_cache.elem[adv_cache.num_elem].p_data = adv_cache.device_name;
+        adv_cache.num_elem++;
+
+        adv_cache.appearance_buf[0] = (uint8_t)appearance;
+        adv_cache.appearance_buf[1] = (uint8_t)(appearance >> 8);
+        adv_cache.elem[adv_cache.num_elem].advert_type = BTM_BLE_ADVERT_TYPE_APPEARANCE;
+        adv_cache.elem[adv_cache.num_elem].len = 2;
+        adv_cache.elem[adv_cache.num_elem].p_data = adv_cache.appearance_buf;
+        adv_cache.num_elem++;
+    }
 
-    result = wiced_bt_mesh_set_raw_scan_response_data(num_elem, adv_elem);
+    result = wiced_bt_mesh_set_raw_scan_response_data(adv_cache.num_elem, adv_cache.elem);
 
     if(WICED_TRUE == result)
     {
@@ -502,5 +824,189 @@ wiced_bool_t mesh_app_adv_config(uint8_t *device_name, uint16_t appearance)
     return result;
 }
 
+/*******************************************************************************
+* Function Name: mesh_app_adv_duty_permille
+********************************************************************************
+* Summary: Share of time the adverts were on since the first fast window.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  uint32_t : duty cycle in per mille
+*
+*******************************************************************************/
+static uint32_t mesh_app_adv_duty_permille(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    uint32_t on_ms = adv_sched.on_ms;
+    uint32_t total_ms = (uint32_t)(now - adv_sched.start_tick) * portTICK_PERIOD_MS;
+
+    if(adv_sched.is_on)
+    {
+        on_ms += (uint32_t)(now - adv_sched.on_tick) * portTICK_PERIOD_MS;
+    }
+    return (0u == total_ms) ? 1000u : (uint32_t)(((uint64_t)on_ms * 1000u) / total_ms);
+}
+
+/*******************************************************************************
+* Function Name: mesh_app_adv_restart_cb
+********************************************************************************
+* Summary: Restart the connectable adverts stopped by the stack, at the end
+*            of the backoff or on a button press. Runs in the stack context,
+*            the timer is rearmed in MESH_ADV_KICK_POLL_MS slices until then.
+*
+* Parameters:
+*  arg : not used
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void mesh_app_adv_restart_cb(WICED_TIMER_PARAM_TYPE arg)
+{
+    TickType_t now = xTaskGetTickCount();
+    int32_t remaining_ms = (int32_t)(adv_sched.restart_tick - now) * (int32_t)portTICK_PERIOD_MS;
+
+    (void)arg;
+
+    if (!adv_sched.kick_pending && (remaining_ms > 0))
+    {
+        wiced_start_timer(&adv_sched.timer, ((uint32_t)remaining_ms < MESH_ADV_KICK_POLL_MS) ?
+                          (uint32_t)remaining_ms : MESH_ADV_KICK_POLL_MS);
+        return;
+    }
+    adv_sched.kick_pending = false;
+
+    if (!mesh_app_gatt_is_connected() && !adv_sched.is_on)
+    {
+        wiced_bt_mesh_core_connection_status(0u, WICED_FALSE, 0, 20);
+    }
+}
+
+/*******************************************************************************
+* Function Name: mesh_app_adv_sched_init
+********************************************************************************
+* Summary: Initialize the advert restart timer, in the stack context.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void mesh_app_adv_sched_init(void)
+{
+    TickType_t now = xTaskGetTickCount();
+
+    if (!adv_sched.is_init)
+    {
+        wiced_init_timer(&adv_sched.timer, mesh_app_adv_restart_cb, 0, WICED_MILLI_SECONDS_TIMER);
+        adv_sched.start_tick = now;
+        adv_sched.on_tick = now;
+        adv_sched.window_tick = now;
+        adv_sched.is_init = true;
+    }
+}
+
+/*******************************************************************************
+* Function Name: mesh_app_adv_kick
+********************************************************************************
+* Summary: Open a fast advertising window, on power-up or a button press.
+*            Callable from any task, the wiced timer is not touched here. A
+*            pending backoff sees the kick within MESH_ADV_KICK_POLL_MS and
+*            restarts the adverts from the stack context.
+*
+* Parameters:
+*  None
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+void mesh_app_adv_kick(void)
+{
+    TickType_t now = xTaskGetTickCount();
+
+    taskENTER_CRITICAL();
+    adv_sched.window_tick = now;
+    adv_sched.backoff_ms = MESH_ADV_BACKOFF_MIN_MS;
+    adv_sched.kick_pending = true;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+* Function Name: mesh_app_adv_state_changed
+********************************************************************************
+* Summary: Track the advert on time and restart the connectable adverts
+*            stopped by the stack, right away when provisioned or within the
+*            fast window, after the backoff otherwise.
+*
+* Parameters:
+*  mode : new advertisement mode
+*
+* Return:
+*  None
+*
+*******************************************************************************/
+static void mesh_app_adv_state_changed(wiced_bt_ble_advert_mode_t mode)
+{
+    TickType_t now = xTaskGetTickCount();
+    bool is_on = (BTM_BLE_ADVERT_OFF != mode);
+    bool is_fast;
+    uint32_t backoff_ms = 0u;
+    uint32_t duty;
+
+    if (adv_sched.is_on && !is_on)
+    {
+        adv_sched.on_ms += (uint32_t)(now - adv_sched.on_tick) * portTICK_PERIOD_MS;
+    }
+    else if (!adv_sched.is_on && is_on)
+    {
+        adv_sched.on_tick = now;
+        mesh_app_factory_reset_report(now);
+    }
+    adv_sched.is_on = is_on;
+
+    if (is_on)
+    {
+        return;
+    }
+
+    APP_LOG0(ADV_STOPPED);
+    // On failed attempt to connect FW stops all connectable adverts.
+    // If we disconnected then notify core to restart them
+    if (mesh_app_gatt_is_connected())
+    {
+        return;
+    }
+
+    /* The window and the backoff are also written by a button press */
+    taskENTER_CRITICAL();
+    is_fast = adv_sched.is_provisioned || !adv_sched.is_init ||
+              (((uint32_t)(now - adv_sched.window_tick) * portTICK_PERIOD_MS) < MESH_ADV_FAST_WINDOW_MS);
+    if (!is_fast)
+    {
+        backoff_ms = adv_sched.backoff_ms;
+        adv_sched.backoff_ms = (backoff_ms >= (MESH_ADV_BACKOFF_MAX_MS / 2u)) ?
+                               MESH_ADV_BACKOFF_MAX_MS : (backoff_ms * 2u);
+        adv_sched.restart_tick = now + pdMS_TO_TICKS(backoff_ms);
+        adv_sched.kick_pending = false;
+    }
+    taskEXIT_CRITICAL();
+
+    if (is_fast)
+    {
+        wiced_bt_mesh_core_connection_status(0u, WICED_FALSE, 0, 20);
+        return;
+    }
+
+    duty = mesh_app_adv_duty_permille();
+    APP_LOG3(ADV_BACKOFF, backoff_ms, duty / 10u, duty % 10u);
+    wiced_start_timer(&adv_sched.timer, (backoff_ms < MESH_ADV_KICK_POLL_MS) ?
+                      backoff_ms : MESH_ADV_KICK_POLL_MS);
+}
+
 
 /* [] END OF FILE */
\ No newline at end of file
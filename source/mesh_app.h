@@ -60,7 +60,17 @@ typedef void (*mesh_app_free_t)(uint8_t *p_buf);
 void mesh_application_init(void);
 void mesh_level_client_model_init(wiced_bool_t is_provisioned);
 void mesh_dimmer_set_level(bool is_instant, bool is_final);
+void mesh_dimmer_send_level(uint16_t dst, wiced_bt_mesh_level_set_level_t *p_data, bool is_final);
+void mesh_dimmer_move_start(bool is_up);
+void mesh_dimmer_move_stop(void);
+wiced_bool_t mesh_dimmer_fanout_set(const uint16_t *p_dst, uint8_t num_dst);
+wiced_bool_t mesh_dimmer_cache_get(uint16_t addr, int16_t *p_level);
+bool mesh_dimmer_sync_step(void);
+void mesh_dimmer_scene_recall(uint16_t scene_number);
+uint32_t mesh_dimmer_repeat_interval_ms(void);
 wiced_bool_t mesh_app_adv_config(uint8_t *device_name, uint16_t appearance);
+void mesh_app_adv_kick(void);
+void mesh_app_factory_reset(void);
 wiced_result_t mesh_management_callback(wiced_bt_management_evt_t event,
                                 wiced_bt_management_evt_data_t *p_event_data);
                                 
@@ -62,6 +62,12 @@ wiced_bt_mesh_core_config_model_t mesh_element1_models[] =
 {
     WICED_BT_MESH_DEVICE,
     WICED_BT_MESH_MODEL_LEVEL_CLIENT,
+#if (MESH_CLIENT_MODE == MESH_CLIENT_MODE_LIGHTNESS_ACTUAL) || (MESH_CLIENT_MODE == MESH_CLIENT_MODE_LIGHTNESS_LINEAR)
+    WICED_BT_MESH_MODEL_LIGHT_LIGHTNESS_CLIENT,
+#elif (MESH_CLIENT_MODE == MESH_CLIENT_MODE_CTL)
+    WICED_BT_MESH_MODEL_LIGHT_CTL_CLIENT,
+#endif
+    WICED_BT_MESH_MODEL_SCENE_CLIENT,
 };
 
 /* MESH elements configuration */
@@ -103,16 +109,16 @@ wiced_bt_mesh_core_config_t  mesh_config =
         .rssi_factor           = 2,                                 // contribution of the RSSI measured by the Friend node used in Friend Offer Delay calculations.
         .receive_window_factor = 2,                                 // contribution of the supported Receive Window used in Friend Offer Delay calculations.
         .min_cache_size_log    = 3,                                 // minimum number of messages that the Friend node can store in its Friend Cache.
-        .receive_delay         = 100,                               // Receive delay in 1 ms units to be requested by the Low Power node.
-        .poll_timeout          = 200                                // Poll timeout in 100ms units to be requested by the Low Power node.
+        .receive_delay         = MESH_LPN_RECEIVE_DELAY,            // Receive delay in 1 ms units to be requested by the Low Power node.
+        .poll_timeout          = MESH_LPN_POLL_TIMEOUT              // Poll timeout in 100ms units to be requested by the Low Power node, adapted by mesh_lpn.c
     },
 #else
     .features = WICED_BT_MESH_CORE_FEATURE_BIT_FRIEND | WICED_BT_MESH_CORE_FEATURE_BIT_RELAY | WICED_BT_MESH_CORE_FEATURE_BIT_GATT_PROXY_SERVER,   // Supports Friend, Relay and GATT Proxy
     .friend_cfg         =                                           // Configuration of the Friend Feature(Receive Window in Ms, messages cache)
     {
         .receive_window        = 20,
-        .cache_buf_len         = 300,                               // Length of the buffer for the cache
-        .max_lpn_num           = 4                                  // Max number of Low Power Nodes with established friendship. Must be > 0 if Friend feature is supported.
+        .cache_buf_len         = MESH_FRIEND_CACHE_LEN,             // Length of the buffer for the cache, sized by mesh_friend.c
+        .max_lpn_num           = MESH_FRIEND_LPN_NUM                // Max number of Low Power Nodes with established friendship. Must be > 0 if Friend feature is supported.
     },
     .low_power          =                                           // Configuration of the Low Power Feature
     {
@@ -61,6 +61,101 @@
 #define MESH_DEVICE_APPERANCE                   APPEARANCE_GENERIC_TAG
 #define MESH_LEVEL_CLIENT_ELEMENT_INDEX         (0u)
 #define MESH_TRANSITION_INTERVAL                (100) // transition duration to new state
+#define MESH_LEVEL_MOVE_RATE                    (16384u) // Generic Level units per second on hold-to-dim (full range in 4 s)
+#define MESH_STEP_INTERVAL_MS                   (500u)  // Shortest interval between hold-to-dim steps
+#define MESH_STEP_INTERVAL_MAX_MS               (1000u) // Longest interval between hold-to-dim steps
+#define MESH_STEP_LATENCY_MARGIN_MS             (50u)   // Added to the delivery latency for the step interval
+#define MESH_STEP_GAP_MAX_MS                    (3u * MESH_STEP_INTERVAL_MAX_MS) // Longer step gaps start a new ramp
+
+// Client model the dimmer commands are sent with. The Generic Level client is
+// always present for hold-to-dim moves.
+#define MESH_CLIENT_MODE_LEVEL                  (0)
+#define MESH_CLIENT_MODE_LIGHTNESS_ACTUAL       (1)
+#define MESH_CLIENT_MODE_LIGHTNESS_LINEAR       (2)
+#define MESH_CLIENT_MODE_CTL                    (3)
+#ifndef MESH_CLIENT_MODE
+#define MESH_CLIENT_MODE                        MESH_CLIENT_MODE_LEVEL
+#endif
+#define MESH_CTL_TEMPERATURE_MIN                (2700u) // Kelvin at the lowest step
+#define MESH_CTL_TEMPERATURE_MAX                (4000u) // Kelvin at full lightness
+#define MESH_CTL_DELTA_UV                       (0)     // CTL Delta UV sent with every set
+
+// Level commands fan-out. Each destination in the list must be followed by a
+// comma, for example 0xC000, 0xC001,  With an empty list the level client
+// publication is used.
+#define MESH_FANOUT_DST_LIST
+#define MESH_FANOUT_MAX_DST                     (8u)    // Maximum number of fan-out destinations
+#define MESH_FANOUT_PACING_MS                   (30u)   // Interval between sends to consecutive destinations
+#define MESH_FANOUT_ALIGN_START                 (1)     // Delay the earlier destinations so all transitions start together
+
+// Restart schedule of the unprovisioned adverts after the stack stops them
+#define MESH_ADV_FAST_WINDOW_MS                 (60000u) // Restart right away within this time from power-up or a button press
+#define MESH_ADV_BACKOFF_MIN_MS                 (1000u)  // First restart delay after the fast window
+#define MESH_ADV_BACKOFF_MAX_MS                 (64000u) // Restart delay doubles up to this value while idle
+#define MESH_ADV_KICK_POLL_MS                   (500u)   // A backoff checks for a button press at this period
+
+// Proxy and PB-GATT connection parameters. A connection starts with the fast
+// parameters, a provisioned node relaxes them after the burst window.
+#define MESH_PROXY_FAST_INTERVAL_MIN            (6u)     // 7.5 ms, in 1.25 ms units
+#define MESH_PROXY_FAST_INTERVAL_MAX            (12u)    // 15 ms
+#define MESH_PROXY_IDLE_INTERVAL_MIN            (80u)    // 100 ms
+#define MESH_PROXY_IDLE_INTERVAL_MAX            (120u)   // 150 ms
+#define MESH_PROXY_IDLE_LATENCY                 (4u)     // Connection events the node may skip when idle
+#define MESH_PROXY_SUPERVISION_TIMEOUT          (600u)   // 6 s, in 10 ms units
+#define MESH_PROXY_BURST_MS                     (15000u) // Time on the fast parameters after a connection
+#define MESH_PROXY_TX_OCTETS                    (251u)   // LE Data Length Extension payload
+#define MESH_PROXY_TX_TIME_US                   (2120u)  // Transmit time of a 251 octet payload on 1M PHY
+#define MESH_PROXY_PKTS_PER_EVENT               (4u)     // Packets assumed per connection event for the printed throughput ceiling
+
+// Level command delivery policy
+#define MESH_TX_POLICY_ADAPTIVE                 (0)     // Selected per destination from the delivery statistics
+#define MESH_TX_POLICY_ACK                      (1)     // Every level command is acknowledged
+#define MESH_TX_POLICY_UNACK                    (2)     // No level command is acknowledged
+#ifndef MESH_TX_POLICY
+#define MESH_TX_POLICY                          MESH_TX_POLICY_ADAPTIVE
+#endif
+#define MESH_TX_ACK_RETRANS_CNT                 (3u)    // Retransmissions of an acknowledged command until the status is received
+#define MESH_TX_UNACK_RETRANS_CNT               (2u)    // Retransmissions of an unacknowledged command to a destination not known to be reliable
+#define MESH_TX_RELIABLE_PCT                    (90u)   // Acknowledged delivery rate for a destination to be reliable
+#define MESH_TX_MIN_SAMPLES                     (4u)    // Acknowledged sends needed before a destination can be reliable
+#define MESH_TX_PROBE_INTERVAL                  (8u)    // Acknowledge every Nth final command to a reliable destination
+#define MESH_TX_COMPLETE_TIMEOUT_MS             (10000u) // A command not completed within this time is no longer in flight
+
+#define MESH_LEVEL_CACHE_SIZE                   (8u)    // Number of servers with a cached level
+
+// Friend cache (not in LOW_POWER_NODE builds), sized at start-up from the free
+// mesh heap before the mesh core allocates it
+#define MESH_FRIEND_CACHE_POLICY_LPNS           (0)     // MESH_FRIEND_CACHE_LEN per LPN, as many LPNs as fit
+#define MESH_FRIEND_CACHE_POLICY_DEPTH          (1)     // MESH_FRIEND_LPN_NUM LPNs, the deepest cache that fits
+#ifndef MESH_FRIEND_CACHE_POLICY
+#define MESH_FRIEND_CACHE_POLICY                MESH_FRIEND_CACHE_POLICY_LPNS
+#endif
+#define MESH_FRIEND_HEAP_SHARE_PCT              (25u)    // Share of the free mesh heap for the friendships
+#define MESH_FRIEND_CACHE_LEN                   (300u)   // Cache per LPN, bytes
+#define MESH_FRIEND_CACHE_MIN_LEN               (150u)   // Smallest cache per LPN, bytes
+#define MESH_FRIEND_CACHE_MAX_LEN               (1200u)  // Largest cache per LPN, bytes
+#define MESH_FRIEND_LPN_NUM                     (4u)     // LPNs with the depth policy, and without heap
+#define MESH_FRIEND_LPN_MAX                     (16u)    // Most LPNs with the LPNS policy
+#define MESH_FRIEND_LPN_OVERHEAD                (64u)    // Friendship state per LPN besides the cache, bytes (estimate)
+#define MESH_FRIEND_MSG_OVERHEAD                (8u)     // Cache bytes per message besides the network PDU (estimate)
+
+// Low Power Node (LOW_POWER_NODE builds). The poll timeout adapts between the
+// limits to the observed use, a new value is used from the next friendship.
+#define MESH_LPN_RECEIVE_DELAY                  (100u)   // Receive delay requested from the friend, in ms
+#define MESH_LPN_POLL_TIMEOUT                   (200u)   // 20 s, poll timeout at first boot, in 100 ms units
+#define MESH_LPN_POLL_TIMEOUT_MIN               (100u)   // 10 s
+#define MESH_LPN_POLL_TIMEOUT_MAX               (36000u) // 1 hour
+#define MESH_LPN_POLLS_PER_SESSION              (4u)     // Polls wanted between two uses of the switch, keeps the cached levels fresh
+#define MESH_LPN_SESSION_GAP_MS                 (10000u) // Commands closer than this belong to the same use
+
+// LPN energy model, from the data sheet figures. Adjust to the board.
+#define MESH_LPN_ADV_PDU_US                     (400u)   // One advertising PDU on one channel, ramp-up included
+#define MESH_LPN_ADV_CHANNELS                   (3u)     // Advertising channels per transmission
+#define MESH_LPN_RX_WINDOW_MS                   (20u)    // Receive window listened to after a poll
+#define MESH_LPN_TX_CURRENT_UA                  (5600u)  // Radio transmit at 0 dBm
+#define MESH_LPN_RX_CURRENT_UA                  (5900u)  // Radio receive
+#define MESH_LPN_SLEEP_CURRENT_UA               (3u)     // Deep sleep with the RAM retained
+#define MESH_LPN_BATTERY_MAH                    (220u)   // CR2032 coin cell
 
 // Definitions for parameters of the wiced_bt_mesh_directed_forwarding_init():
 #define MESH_DIRECTED_FORWARDING_DIRECTED_PROXY_SUPPORTED   WICED_TRUE  // WICED_TRUE if directed proxy is supported.
@@ -0,0 +1,359 @@
+/*******************************************************************************
+* File Name: mesh_friend.c
+*
+* Description: Friend cache sizing. The mesh core allocates the friend cache
+*              from the mesh heap with the sizes in mesh_config, so they are
+*              chosen from the free heap and MESH_FRIEND_CACHE_POLICY before
+*              the core starts. The friend queues live inside the mesh core,
+*              so their occupancy is not visible to the application. A model
+*              of the queues with the same sizes is benchmarked with simulated
+*              LPN polls instead.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <string.h>
+#include "cybsp.h"
+#include "cy_retarget_io.h"
+#include "wiced_memory.h"
+#include "mesh_friend.h"
+
+#if !(defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1))
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Friend queue benchmark: the LPNs poll every MESH_FRIEND_BENCH_POLL_MS times
+ * 1 to 4, and receive a message in a step with MESH_FRIEND_BENCH_RATE_PERMILLE
+ * probability. A poll delivers the whole queue, the LPN polls again while the
+ * friend has more data. */
+#define MESH_FRIEND_BENCH_STEP_MS           (100u)
+#define MESH_FRIEND_BENCH_DURATION_MS       (120000u)
+#define MESH_FRIEND_BENCH_POLL_MS           (2000u)
+#define MESH_FRIEND_BENCH_RATE_PERMILLE     (150u)
+#define MESH_FRIEND_BENCH_PDU_MIN           (14u)    /* network PDU, unsegmented control */
+#define MESH_FRIEND_BENCH_PDU_MAX           (29u)    /* network PDU, largest */
+#define MESH_FRIEND_BENCH_QUEUE_LEN         (64u)    /* messages, power of two */
+
+/*******************************************************************************
+ * Variables Definitions
+ ******************************************************************************/
+extern wiced_bt_heap_t* p_mesh_heap;
+
+static mesh_friend_sizing_t friend_sizing;
+
+#ifdef ENABLE_RUNTIME_STATS
+/* Friend queue model of one LPN: the cache bytes of the queued messages */
+typedef struct
+{
+    uint8_t len[MESH_FRIEND_BENCH_QUEUE_LEN];
+    uint32_t head;
+    uint32_t tail;
+    uint32_t bytes;
+    uint32_t next_poll_ms;
+} mesh_friend_queue_t;
+
+static mesh_friend_queue_t friend_queue[MESH_FRIEND_LPN_MAX];
+static mesh_friend_lpn_stats_t friend_lpn_stats[MESH_FRIEND_LPN_MAX];
+
+_Static_assert((MESH_FRIEND_BENCH_QUEUE_LEN & (MESH_FRIEND_BENCH_QUEUE_LEN - 1u)) == 0u,
+               "MESH_FRIEND_BENCH_QUEUE_LEN must be a power of two");
+#endif
+
+/*******************************************************************************
+ * Function Name: mesh_friend_cache_init
+ *******************************************************************************
+ * Summary:
+ *  Size the friend cache in mesh_config from the free mesh heap. The
+ *  friendships get MESH_FRIEND_HEAP_SHARE_PCT of it, the rest is left to the
+ *  mesh core. With the LPNS policy the cache per LPN is fixed and the number
+ *  of LPNs grows with the heap, with the DEPTH policy the number of LPNs is
+ *  fixed and the cache grows. A cache is never larger than the largest free
+ *  block. Must be called before the mesh core is initialized.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void mesh_friend_cache_init(void)
+{
+    wiced_bt_heap_statistics_t heap_stats;
+    uint32_t cache_len;
+    uint32_t lpn_num;
+
+    if(!wiced_bt_get_heap_statistics(p_mesh_heap, &heap_stats))
+    {
+        /* Keep the sizes of mesh_config */
+        friend_sizing.cache_len = mesh_config.friend_cfg.cache_buf_len;
+        friend_sizing.lpn_num = mesh_config.friend_cfg.max_lpn_num;
+        mesh_friend_print();
+        return;
+    }
+    friend_sizing.heap_free = heap_stats.heap_size - heap_stats.current_size_allocated;
+    friend_sizing.budget = (friend_sizing.heap_free / 100u) * MESH_FRIEND_HEAP_SHARE_PCT;
+
+#if (MESH_FRIEND_CACHE_POLICY == MESH_FRIEND_CACHE_POLICY_DEPTH)
+    lpn_num = MESH_FRIEND_LPN_NUM;
+    cache_len = friend_sizing.budget / lpn_num;
+    cache_len = (cache_len > MESH_FRIEND_LPN_OVERHEAD) ? (cache_len - MESH_FRIEND_LPN_OVERHEAD) : 0u;
+#else
+    cache_len = MESH_FRIEND_CACHE_LEN;
+    lpn_num = friend_sizing.budget / (MESH_FRIEND_CACHE_LEN + MESH_FRIEND_LPN_OVERHEAD);
+    if(lpn_num > MESH_FRIEND_LPN_MAX)
+    {
+        lpn_num = MESH_FRIEND_LPN_MAX;
+    }
+    else if(0u == lpn_num)
+    {
+        /* A single friendship with the cache that fits */
+        lpn_num = 1u;
+        cache_len = (friend_sizing.budget > MESH_FRIEND_LPN_OVERHEAD) ?
+                    (friend_sizing.budget - MESH_FRIEND_LPN_OVERHEAD) : 0u;
+    }
+#endif
+
+    if(cache_len > heap_stats.current_largest_free_size)
+    {
+        cache_len = heap_stats.current_largest_free_size;
+    }
+    if(cache_len > MESH_FRIEND_CACHE_MAX_LEN)
+    {
+        cache_len = MESH_FRIEND_CACHE_MAX_LEN;
+    }
+    else if(cache_len < MESH_FRIEND_CACHE_MIN_LEN)
+    {
+        printf("Friend cache: heap too small, %ld bytes free\n", friend_sizing.heap_free);
+        cache_len = MESH_FRIEND_CACHE_MIN_LEN;
+    }
+
+    friend_sizing.cache_len = (uint16_t)cache_len;
+    friend_sizing.lpn_num = (uint8_t)lpn_num;
+    mesh_config.friend_cfg.cache_buf_len = friend_sizing.cache_len;
+    mesh_config.friend_cfg.max_lpn_num = friend_sizing.lpn_num;
+    mesh_friend_print();
+}
+
+/*******************************************************************************
+ * Function Name: mesh_friend_get_sizing
+ *******************************************************************************
+ * Summary:
+ *  Get the friend cache chosen at start-up.
+ *
+ * Parameters:
+ *  mesh_friend_sizing_t *p_sizing : sizing
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void mesh_friend_get_sizing(mesh_friend_sizing_t *p_sizing)
+{
+    *p_sizing = friend_sizing;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_friend_print
+ *******************************************************************************
+ * Summary:
+ *  Print the friend cache sizing.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void mesh_friend_print(void)
+{
+    printf("Friend cache: %d LPNs x %d bytes, %ld of %ld free heap bytes\n", mesh_config.friend_cfg.max_lpn_num,
+           mesh_config.friend_cfg.cache_buf_len, friend_sizing.budget, friend_sizing.heap_free);
+}
+
+#ifdef ENABLE_RUNTIME_STATS
+/*******************************************************************************
+ * Function Name: mesh_friend_enqueue
+ *******************************************************************************
+ * Summary:
+ *  Store a message in the friend queue model. When the cache is full the
+ *  oldest messages are discarded, as the friend does.
+ *
+ * Parameters:
+ *  uint8_t lpn : LPN index
+ *  uint8_t len : cache bytes of the message
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_friend_enqueue(uint8_t lpn, uint8_t len)
+{
+    mesh_friend_queue_t *p_queue = &friend_queue[lpn];
+    mesh_friend_lpn_stats_t *p_stats = &friend_lpn_stats[lpn];
+    bool overflow = false;
+
+    while(((p_queue->bytes + len) > friend_sizing.cache_len) ||
+          ((p_queue->head - p_queue->tail) >= MESH_FRIEND_BENCH_QUEUE_LEN))
+    {
+        p_queue->bytes -= p_queue->len[p_queue->tail & (MESH_FRIEND_BENCH_QUEUE_LEN - 1u)];
+        p_queue->tail++;
+        p_stats->dropped++;
+        overflow = true;
+    }
+    p_queue->len[p_queue->head & (MESH_FRIEND_BENCH_QUEUE_LEN - 1u)] = len;
+    p_queue->head++;
+    p_queue->bytes += len;
+
+    p_stats->enqueued++;
+    p_stats->overflows += overflow ? 1u : 0u;
+    if(p_queue->bytes > p_stats->peak_bytes)
+    {
+        p_stats->peak_bytes = (uint16_t)p_queue->bytes;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: mesh_friend_poll
+ *******************************************************************************
+ * Summary:
+ *  Deliver the friend queue model to a polling LPN.
+ *
+ * Parameters:
+ *  uint8_t lpn : LPN index
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_friend_poll(uint8_t lpn)
+{
+    mesh_friend_queue_t *p_queue = &friend_queue[lpn];
+
+    while(p_queue->tail != p_queue->head)
+    {
+        p_queue->bytes -= p_queue->len[p_queue->tail & (MESH_FRIEND_BENCH_QUEUE_LEN - 1u)];
+        p_queue->tail++;
+        friend_lpn_stats[lpn].delivered++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: mesh_friend_benchmark
+ *******************************************************************************
+ * Summary:
+ *  Run simulated LPN traffic through a model of the friend queues with the
+ *  cache sizes chosen at start-up, and print the CPU cycles per message, the
+ *  message rate the CPU could queue and deliver, and the occupancy, overflow
+ *  and drops of every LPN.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  uint32_t : cycles per message, 0 without friendships or messages
+ *
+ ******************************************************************************/
+uint32_t mesh_friend_benchmark(void)
+{
+    uint8_t lpn_num = friend_sizing.lpn_num;
+    uint32_t seed = DWT->CYCCNT;
+    uint32_t messages = 0u;
+    uint32_t cycles = 0u;
+    uint32_t start;
+    uint8_t len;
+
+    if(0u == lpn_num)
+    {
+        return 0u;
+    }
+
+    memset(friend_queue, 0, sizeof(friend_queue));
+    memset(friend_lpn_stats, 0, sizeof(friend_lpn_stats));
+    for(uint8_t lpn = 0u; lpn < lpn_num; lpn++)
+    {
+        friend_lpn_stats[lpn].poll_ms = MESH_FRIEND_BENCH_POLL_MS * (1u + (lpn % 4u));
+        friend_queue[lpn].next_poll_ms = friend_lpn_stats[lpn].poll_ms;
+    }
+
+    for(uint32_t now_ms = 0u; now_ms < MESH_FRIEND_BENCH_DURATION_MS; now_ms += MESH_FRIEND_BENCH_STEP_MS)
+    {
+        for(uint8_t lpn = 0u; lpn < lpn_num; lpn++)
+        {
+            seed = (seed * 1664525u) + 1013904223u;
+            if(((seed >> 8) % 1000u) < MESH_FRIEND_BENCH_RATE_PERMILLE)
+            {
+                len = (uint8_t)(MESH_FRIEND_BENCH_PDU_MIN + ((seed >> 20) % (MESH_FRIEND_BENCH_PDU_MAX -
+                                MESH_FRIEND_BENCH_PDU_MIN + 1u)) + MESH_FRIEND_MSG_OVERHEAD);
+                start = DWT->CYCCNT;
+                mesh_friend_enqueue(lpn, len);
+                cycles += DWT->CYCCNT - start;
+                messages++;
+            }
+            if(now_ms >= friend_queue[lpn].next_poll_ms)
+            {
+                start = DWT->CYCCNT;
+                mesh_friend_poll(lpn);
+                cycles += DWT->CYCCNT - start;
+                friend_queue[lpn].next_poll_ms += friend_lpn_stats[lpn].poll_ms;
+            }
+        }
+    }
+
+    printf("Friend queue benchmark, %ld messages in %lds:\n", messages, MESH_FRIEND_BENCH_DURATION_MS / 1000u);
+    if((0u != cycles) && (0u != messages))
+    {
+        printf("  %ld cycles per message, %ld messages/s\n", cycles / messages,
+               (uint32_t)(((uint64_t)messages * SystemCoreClock) / cycles));
+    }
+    for(uint8_t lpn = 0u; lpn < lpn_num; lpn++)
+    {
+        printf("  LPN %d poll %ldms: queued %ld delivered %ld dropped %ld overflows %ld peak %d/%d bytes\n", lpn,
+               friend_lpn_stats[lpn].poll_ms, friend_lpn_stats[lpn].enqueued, friend_lpn_stats[lpn].delivered,
+               friend_lpn_stats[lpn].dropped, friend_lpn_stats[lpn].overflows, friend_lpn_stats[lpn].peak_bytes,
+               friend_sizing.cache_len);
+    }
+    return (0u != messages) ? (cycles / messages) : 0u;
+}
+#endif
+
+#endif /* !LOW_POWER_NODE */
+
+/* [] END OF FILE */
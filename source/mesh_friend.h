@@ -0,0 +1,86 @@
+/*******************************************************************************
+* File Name: mesh_friend.h
+*
+* Description: This file is the public interface of mesh_friend.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef MESH_FRIEND_H_
+#define MESH_FRIEND_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "stdint.h"
+#include "stdbool.h"
+#include "mesh_cfg.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Friend cache chosen at start-up */
+typedef struct
+{
+    uint32_t heap_free;                         /* free mesh heap at start-up */
+    uint32_t budget;                            /* share given to the friendships */
+    uint16_t cache_len;                         /* cache per LPN, bytes */
+    uint8_t lpn_num;
+} mesh_friend_sizing_t;
+
+/* Friend queue of one simulated LPN */
+typedef struct
+{
+    uint32_t poll_ms;                           /* poll interval */
+    uint32_t enqueued;
+    uint32_t delivered;
+    uint32_t dropped;                           /* oldest messages discarded on overflow */
+    uint32_t overflows;                         /* messages that overflowed the cache */
+    uint16_t peak_bytes;                        /* highest cache occupancy */
+} mesh_friend_lpn_stats_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void mesh_friend_cache_init(void);
+void mesh_friend_get_sizing(mesh_friend_sizing_t *p_sizing);
+void mesh_friend_print(void);
+#ifdef ENABLE_RUNTIME_STATS
+uint32_t mesh_friend_benchmark(void);
+#endif
+
+#endif /* MESH_FRIEND_H_ */
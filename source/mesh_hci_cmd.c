@@ -0,0 +1,674 @@
+/*******************************************************************************
+* File Name: mesh_hci_cmd.c
+*
+* Description: This file contains the dispatcher of the commands sent by a
+*              host MCU over the WICED HCI transport. Commands are looked up
+*              by opcode in a table and parsed in place from the received
+*              frame. A batch frame carries several commands, so the host can
+*              drive many destinations with one transport round trip.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "cy_retarget_io.h"
+#include "wiced_bt_mesh_models.h"
+#include "mesh_application.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "board.h"
+#include "mesh_cfg.h"
+#include "mesh_app.h"
+#include "app_log.h"
+#include "hci_trace.h"
+#include "runtime_stats.h"
+#include "rtos_heap.h"
+#include "mesh_lpn.h"
+#include "mesh_friend.h"
+#include "mesh_hci_cmd.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define MESH_HCI_CMD_NUM                    (0x08u) /* table size, highest command code + 1 */
+#define MESH_HCI_CMD_CODE(opcode)           ((uint8_t)((opcode) & 0xFFu))
+
+/* Batch record header: opcode and parameter length */
+#define MESH_HCI_BATCH_HDR_LEN              (3u)
+
+#define MESH_HCI_LEVEL_SET_LEN              (11u)
+#define MESH_HCI_LEVEL_SET_FINAL            (0x01u)
+#define MESH_HCI_GESTURE_LEN                (3u)
+#define MESH_HCI_RUNTIME_STATS_PRINT        (0x01u)
+#define MESH_HCI_RUNTIME_STATS_HEAP_TRACE   (0x04u)
+#define MESH_HCI_RUNTIME_STATS_TRACE_BENCH  (0x08u)
+#define MESH_HCI_RUNTIME_STATS_FRIEND_BENCH (0x10u)
+/* Flags run by the benchmark task */
+#define MESH_HCI_RUNTIME_STATS_BENCH        (MESH_HCI_RUNTIME_STATS_TRACE_BENCH | MESH_HCI_RUNTIME_STATS_FRIEND_BENCH)
+#define MESH_HCI_TRACE_MODULE_ALL           (0xFFu)
+
+/* The benchmarks run below the Bluetooth tasks, at the priority of the log task */
+#define MESH_HCI_BENCH_TASK_PRIORITY        (tskIDLE_PRIORITY + 1u)
+#define MESH_HCI_BENCH_TASK_STACK_SIZE      (512u * 2u)
+#define MESH_HCI_BENCH_EVT_MAX_LEN          (1u + 2u * sizeof(uint32_t))
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+static uint8_t mesh_hci_cmd_level_set(const uint8_t *p_data, uint32_t length);
+static uint8_t mesh_hci_cmd_fanout_set(const uint8_t *p_data, uint32_t length);
+static uint8_t mesh_hci_cmd_scene_recall(const uint8_t *p_data, uint32_t length);
+static uint8_t mesh_hci_cmd_config(const uint8_t *p_data, uint32_t length);
+static uint8_t mesh_hci_cmd_stats_get(const uint8_t *p_data, uint32_t length);
+static uint8_t mesh_hci_cmd_batch(const uint8_t *p_data, uint32_t length);
+#ifdef ENABLE_RUNTIME_STATS
+static uint8_t mesh_hci_cmd_runtime_stats(const uint8_t *p_data, uint32_t length);
+#endif
+
+/*******************************************************************************
+ * Variables Definitions
+ ******************************************************************************/
+/* Command handler. The parameters point into the received frame and are only
+ * valid during the call. */
+typedef uint8_t (*mesh_hci_cmd_handler_t)(const uint8_t *p_data, uint32_t length);
+
+typedef struct
+{
+    mesh_hci_cmd_handler_t handler;
+    uint16_t min_len;
+    uint16_t max_len;
+    bool in_batch;                              /* allowed inside a batch frame */
+} mesh_hci_cmd_entry_t;
+
+/* Dispatch table indexed by the command code of the opcode */
+static const mesh_hci_cmd_entry_t mesh_hci_cmd_table[MESH_HCI_CMD_NUM] =
+{
+    [MESH_HCI_CMD_CODE(MESH_HCI_CMD_LEVEL_SET)]    = { mesh_hci_cmd_level_set,    MESH_HCI_LEVEL_SET_LEN,
+                                                       MESH_HCI_LEVEL_SET_LEN, true },
+    [MESH_HCI_CMD_CODE(MESH_HCI_CMD_FANOUT_SET)]   = { mesh_hci_cmd_fanout_set,   0u,
+                                                       MESH_FANOUT_MAX_DST * sizeof(uint16_t), true },
+    [MESH_HCI_CMD_CODE(MESH_HCI_CMD_SCENE_RECALL)] = { mesh_hci_cmd_scene_recall, 2u, 2u, true },
+    [MESH_HCI_CMD_CODE(MESH_HCI_CMD_CONFIG)]       = { mesh_hci_cmd_config,       2u, 0xFFu, true },
+    [MESH_HCI_CMD_CODE(MESH_HCI_CMD_STATS_GET)]    = { mesh_hci_cmd_stats_get,    0u, 0u, true },
+    [MESH_HCI_CMD_CODE(MESH_HCI_CMD_BATCH)]        = { mesh_hci_cmd_batch,        0u, 0xFFFFu, false },
+#ifdef ENABLE_RUNTIME_STATS
+    [MESH_HCI_CMD_CODE(MESH_HCI_CMD_RUNTIME_STATS)] = { mesh_hci_cmd_runtime_stats, 1u, 1u, true },
+#endif
+};
+
+/* Dispatcher counters */
+typedef struct
+{
+    uint32_t frames;                            /* frames received */
+    uint32_t commands;                          /* commands executed, batched ones included */
+    uint32_t errors;                            /* commands rejected */
+} mesh_hci_cmd_stats_t;
+
+static mesh_hci_cmd_stats_t hci_cmd_stats;
+
+/* Set while the commands of a batch frame run */
+static bool hci_cmd_in_batch = false;
+
+#ifdef ENABLE_RUNTIME_STATS
+/* Benchmark task, NULL when no benchmark runs */
+static TaskHandle_t hci_bench_task_handle = NULL;
+#endif
+
+/*******************************************************************************
+ * Function Name: mesh_hci_cmd_get_u16
+ *******************************************************************************
+ * Summary:
+ *  Read a little endian 16 bit field from a frame.
+ *
+ * Parameters:
+ *  const uint8_t *p : field
+ *
+ * Return:
+ *  uint16_t : value
+ *
+ ******************************************************************************/
+static inline uint16_t mesh_hci_cmd_get_u16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | ((uint16_t)p[1] << 8));
+}
+
+/*******************************************************************************
+ * Function Name: mesh_hci_cmd_get_u32
+ *******************************************************************************
+ * Summary:
+ *  Read a little endian 32 bit field from a frame.
+ *
+ * Parameters:
+ *  const uint8_t *p : field
+ *
+ * Return:
+ *  uint32_t : value
+ *
+ ******************************************************************************/
+static inline uint32_t mesh_hci_cmd_get_u32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+/*******************************************************************************
+ * Function Name: mesh_hci_cmd_put_u32
+ *******************************************************************************
+ * Summary:
+ *  Write a little endian 32 bit field to an event.
+ *
+ * Parameters:
+ *  uint8_t *p : field
+ *  uint32_t value : value
+ *
+ * Return:
+ *  uint8_t * : next field
+ *
+ ******************************************************************************/
+static uint8_t *mesh_hci_cmd_put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+    return p + 4;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_hci_cmd_dispatch
+ *******************************************************************************
+ * Summary:
+ *  Look up a command in the dispatch table, check its length and run it.
+ *
+ * Parameters:
+ *  uint16_t opcode : command opcode
+ *  const uint8_t *p_data : command parameters
+ *  uint32_t length : length of the parameters
+ *  bool in_batch : the command comes from a batch frame
+ *
+ * Return:
+ *  uint8_t : MESH_HCI_STATUS_*
+ *
+ ******************************************************************************/
+static uint8_t mesh_hci_cmd_dispatch(uint16_t opcode, const uint8_t *p_data, uint32_t length, bool in_batch)
+{
+    const mesh_hci_cmd_entry_t *p_entry;
+    uint8_t status;
+
+    if(!mesh_hci_cmd_is_app_opcode(opcode) || (MESH_HCI_CMD_CODE(opcode) >= MESH_HCI_CMD_NUM) ||
+       (NULL == mesh_hci_cmd_table[MESH_HCI_CMD_CODE(opcode)].handler))
+    {
+        status = MESH_HCI_STATUS_UNKNOWN_OPCODE;
+    }
+    else
+    {
+        p_entry = &mesh_hci_cmd_table[MESH_HCI_CMD_CODE(opcode)];
+        if(in_batch && !p_entry->in_batch)
+        {
+            status = MESH_HCI_STATUS_BAD_PARAM;
+        }
+        else if((length < p_entry->min_len) || (length > p_entry->max_len))
+        {
+            status = MESH_HCI_STATUS_BAD_LENGTH;
+        }
+        else
+        {
+            status = p_entry->handler(p_data, length);
+        }
+    }
+
+    /* A batch is counted through the commands it carries */
+    if((MESH_HCI_CMD_BATCH == opcode) && !in_batch)
+    {
+        return status;
+    }
+    if(MESH_HCI_STATUS_SUCCESS == status)
+    {
+        hci_cmd_stats.commands++;
+    }
+    else
+    {
+        hci_cmd_stats.errors++;
+    }
+    return status;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_hci_cmd_level_set
+ *******************************************************************************
+ * Summary:
+ *  LEVEL_SET: send a level to one destination or to the fan-out destinations.
+ *
+ * Parameters:
+ *  const uint8_t *p_data : command parameters
+ *  uint32_t length : length of the parameters
+ *
+ * Return:
+ *  uint8_t : MESH_HCI_STATUS_*
+ *
+ ******************************************************************************/
+static uint8_t mesh_hci_cmd_level_set(const uint8_t *p_data, uint32_t length)
+{
+    wiced_bt_mesh_level_set_level_t set_data;
+    uint16_t dst = mesh_hci_cmd_get_u16(&p_data[0]);
+
+    (void)length;
+
+    set_data.level = (int16_t)mesh_hci_cmd_get_u16(&p_data[2]);
+    set_data.transition_time = mesh_hci_cmd_get_u32(&p_data[4]);
+    set_data.delay = mesh_hci_cmd_get_u16(&p_data[8]);
+
+    mesh_dimmer_send_level(dst, &set_data, 0u != (p_data[10] & MESH_HCI_LEVEL_SET_FINAL));
+    return MESH_HCI_STATUS_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_hci_cmd_fanout_set
+ *******************************************************************************
+ * Summary:
+ *  FANOUT_SET: replace the fan-out destinations.
+ *
+ * Parameters:
+ *  const uint8_t *p_data : command parameters
+ *  uint32_t length : length of the parameters
+ *
+ * Return:
+ *  uint8_t : MESH_HCI_STATUS_*
+ *
+ ******************************************************************************/
+static uint8_t mesh_hci_cmd_fanout_set(const uint8_t *p_data, uint32_t length)
+{
+    uint16_t dst[MESH_FANOUT_MAX_DST];
+    uint8_t num_dst = (uint8_t)(length / sizeof(uint16_t));
+    uint8_t i;
+
+    if(0u != (length % sizeof(uint16_t)))
+    {
+        return MESH_HCI_STATUS_BAD_LENGTH;
+    }
+    /* The frame is not aligned, the addresses are unpacked */
+    for(i = 0u; i < num_dst; i++)
+    {
+        dst[i] = mesh_hci_cmd_get_u16(&p_data[i * sizeof(uint16_t)]);
+        if(0u == dst[i])
+        {
+            return MESH_HCI_STATUS_BAD_PARAM;
+        }
+    }
+    return mesh_dimmer_fanout_set(dst, num_dst) ? MESH_HCI_STATUS_SUCCESS : MESH_HCI_STATUS_FAILED;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_hci_cmd_scene_recall
+ *******************************************************************************
+ * Summary:
+ *  SCENE_RECALL: recall a scene on the client publication.
+ *
+ * Parameters:
+ *  const uint8_t *p_data : command parameters
+ *  uint32_t length : length of the parameters
+ *
+ * Return:
+ *  uint8_t : MESH_HCI_STATUS_*
+ *
+ ******************************************************************************/
+static uint8_t mesh_hci_cmd_scene_recall(const uint8_t *p_data, uint32_t length)
+{
+    uint16_t scene_number = mesh_hci_cmd_get_u16(p_data);
+
+    (void)length;
+
+    if(0u == scene_number)
+    {
+        return MESH_HCI_STATUS_BAD_PARAM;
+    }
+    mesh_dimmer_scene_recall(scene_number);
+    return MESH_HCI_STATUS_SUCCESS;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_hci_cmd_config
+ *******************************************************************************
+ * Summary:
+ *  CONFIG: change one run time setting.
+ *
+ * Parameters:
+ *  const uint8_t *p_data : command parameters
+ *  uint32_t length : length of the parameters
+ *
+ * Return:
+ *  uint8_t : MESH_HCI_STATUS_*
+ *
+ ******************************************************************************/
+static uint8_t mesh_hci_cmd_config(const uint8_t *p_data, uint32_t length)
+{
+    button_gesture_t gesture;
+
+    switch(p_data[0])
+    {
+    case MESH_HCI_CFG_SHORT_PRESS:
+    case MESH_HCI_CFG_DOUBLE_PRESS:
+        if((1u + MESH_HCI_GESTURE_LEN) != length)
+        {
+            return MESH_HCI_STATUS_BAD_LENGTH;
+        }
+        if(p_data[1] > BUTTON_ACTION_SCENE_RECALL)
+        {
+            return MESH_HCI_STATUS_BAD_PARAM;
+        }
+        gesture.action = (button_action_t)p_data[1];
+        gesture.scene_number = mesh_hci_cmd_get_u16(&p_data[2]);
+        return board_button_set_gesture(USER_BUTTON1, MESH_HCI_CFG_DOUBLE_PRESS == p_data[0], &gesture) ?
+               MESH_HCI_STATUS_SUCCESS : MESH_HCI_STATUS_BAD_PARAM;
+
+#if defined(ENABLE_BT_SPY_LOG) && defined(ENABLE_HCI_TRACES)
+    case MESH_HCI_CFG_HCI_TRACE:
+        if(2u != length)
+        {
+            return MESH_HCI_STATUS_BAD_LENGTH;
+        }
+        hci_trace_filter_all(0u != p_data[1]);
+        return MESH_HCI_STATUS_SUCCESS;
+#endif
+
+    case MESH_HCI_CFG_TRACE_LEVEL:
+        if(3u != length)
+        {
+            return MESH_HCI_STATUS_BAD_LENGTH;
+        }
+        if(MESH_HCI_TRACE_MODULE_ALL != p_data[1])
+        {
+            return app_log_set_level(p_data[1], p_data[2]) ? MESH_HCI_STATUS_SUCCESS : MESH_HCI_STATUS_BAD_PARAM;
+        }
+        for(uint8_t module = 0u; module < APP_LOG_NUM_MODULES; module++)
+        {
+            if(!app_log_set_level(module, p_data[2]))
+            {
+                return MESH_HCI_STATUS_BAD_PARAM;
+            }
+        }
+        return MESH_HCI_STATUS_SUCCESS;
+
+    default:
+        return MESH_HCI_STATUS_BAD_PARAM;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: mesh_hci_cmd_stats_get
+ *******************************************************************************
+ * Summary:
+ *  STATS_GET: report the dispatcher and logging counters in a
+ *  MESH_HCI_EVT_STATS event: frames(4) commands(4) errors(4)
+ *  log dropped(4) HCI trace dropped(4).
+ *
+ * Parameters:
+ *  const uint8_t *p_data : command parameters
+ *  uint32_t length : length of the parameters
+ *
+ * Return:
+ *  uint8_t : MESH_HCI_STATUS_*
+ *
+ ******************************************************************************/
+static uint8_t mesh_hci_cmd_stats_get(const uint8_t *p_data, uint32_t length)
+{
+    uint8_t event[5u * sizeof(uint32_t)];
+    uint8_t *p = event;
+    uint32_t trace_dropped = 0u;
+#if defined(ENABLE_BT_SPY_LOG) && defined(ENABLE_HCI_TRACES)
+    hci_trace_stats_t trace_stats;
+
+    hci_trace_get_stats(&trace_stats);
+    trace_dropped = trace_stats.dropped;
+#endif
+
+    (void)p_data;
+    (void)length;
+
+    p = mesh_hci_cmd_put_u32(p, hci_cmd_stats.frames);
+    /* The STATS_GET itself is counted once it completes */
+    p = mesh_hci_cmd_put_u32(p, hci_cmd_stats.commands + 1u);
+    p = mesh_hci_cmd_put_u32(p, hci_cmd_stats.errors);
+    p = mesh_hci_cmd_put_u32(p, app_log_dropped());
+    p = mesh_hci_cmd_put_u32(p, trace_dropped);
+
+    mesh_application_send_hci_event(MESH_HCI_EVT_STATS, event, (uint16_t)(p - event));
+    return MESH_HCI_STATUS_SUCCESS;
+}
+
+#ifdef ENABLE_RUNTIME_STATS
+/*******************************************************************************
+ * Function Name: mesh_hci_cmd_bench_task
+ *******************************************************************************
+ * Summary:
+ *  Run the benchmarks requested by RUNTIME_STATS, send their results in a
+ *  MESH_HCI_EVT_BENCHMARK event and delete the task.
+ *
+ * Parameters:
+ *  void *pvParameters : RUNTIME_STATS benchmark flags
+ *
+ * Return:
+ *  None
+ *
+ ******************************************************************************/
+static void mesh_hci_cmd_bench_task(void *pvParameters)
+{
+    uint8_t flags = (uint8_t)(uint32_t)pvParameters;
+    uint8_t event[MESH_HCI_BENCH_EVT_MAX_LEN];
+    uint8_t *p = event;
+
+    *p++ = flags;
+    if(0u != (flags & MESH_HCI_RUNTIME_STATS_TRACE_BENCH))
+    {
+        p = mesh_hci_cmd_put_u32(p, app_log_benchmark());
+    }
+    if(0u != (flags & MESH_HCI_RUNTIME_STATS_FRIEND_BENCH))
+    {
+#if !(defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1))
+        p = mesh_hci_cmd_put_u32(p, mesh_friend_benchmark());
+#else
+        p = mesh_hci_cmd_put_u32(p, 0u);
+#endif
+    }
+    mesh_application_send_hci_event(MESH_HCI_EVT_BENCHMARK, event, (uint16_t)(p - event));
+
+    hci_bench_task_handle = NULL;
+    vTaskDelete(NULL);
+}
+
+/*******************************************************************************
+ * Function Name: mesh_hci_cmd_runtime_stats
+ *******************************************************************************
+ * Summary:
+ *  RUNTIME_STATS: sample the run time statistics and send them in a
+ *  MESH_HCI_EVT_RUNTIME_STATS event. The benchmarks are handed to a low
+ *  priority task, so the Bluetooth stack task is not held up by them. They
+ *  are not accepted inside a batch.
+ *
+ * Parameters:
+ *  const uint8_t *p_data : command parameters
+ *  uint32_t length : length of the parameters
+ *
+ * Return:
+ *  uint8_t : MESH_HCI_STATUS_*
+ *
+ ******************************************************************************/
+static uint8_t mesh_hci_cmd_runtime_stats(const uint8_t *p_data, uint32_t length)
+{
+    static runtime_stats_t stats;
+    static uint8_t blob[RUNTIME_STATS_BLOB_MAX_LEN];
+    uint32_t blob_len;
+
+    (void)length;
+
+    if(0u != (p_data[0] & MESH_HCI_RUNTIME_STATS_BENCH))
+    {
+        if(hci_cmd_in_batch || (NULL != hci_bench_task_handle))
+        {
+            return MESH_HCI_STATUS_BAD_PARAM;
+        }
+        if(pdPASS != xTaskCreate(mesh_hci_cmd_bench_task, "Bench Task", MESH_HCI_BENCH_TASK_STACK_SIZE,
+                                 (void *)(uint32_t)(p_data[0] & MESH_HCI_RUNTIME_STATS_BENCH),
+                                 MESH_HCI_BENCH_TASK_PRIORITY, &hci_bench_task_handle))
+        {
+            hci_bench_task_handle = NULL;
+            return MESH_HCI_STATUS_FAILED;
+        }
+    }
+
+    runtime_stats_sample(&stats);
+    if(0u != (p_data[0] & MESH_HCI_RUNTIME_STATS_PRINT))
+    {
+        runtime_stats_print(&stats);
+        rtos_heap_print();
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+        mesh_lpn_print();
+#else
+        mesh_friend_print();
+#endif
+    }
+    if(0u != (p_data[0] & MESH_HCI_RUNTIME_STATS_HEAP_TRACE))
+    {
+        rtos_heap_trace_dump();
+    }
+
+    blob_len = runtime_stats_serialize(&stats, blob, sizeof(blob));
+    if(0u == blob_len)
+    {
+        return MESH_HCI_STATUS_FAILED;
+    }
+    mesh_application_send_hci_event(MESH_HCI_EVT_RUNTIME_STATS, blob, (uint16_t)blob_len);
+    return MESH_HCI_STATUS_SUCCESS;
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: mesh_hci_cmd_batch
+ *******************************************************************************
+ * Summary:
+ *  BATCH: run the commands of a batch frame in order. The records are parsed
+ *  in place, the first failed command stops the batch.
+ *
+ * Parameters:
+ *  const uint8_t *p_data : batch records
+ *  uint32_t length : length of the records
+ *
+ * Return:
+ *  uint8_t : MESH_HCI_STATUS_*
+ *
+ ******************************************************************************/
+static uint8_t mesh_hci_cmd_batch(const uint8_t *p_data, uint32_t length)
+{
+    const uint8_t *p_end = p_data + length;
+    uint16_t opcode;
+    uint8_t param_len;
+    uint8_t status = MESH_HCI_STATUS_SUCCESS;
+
+    hci_cmd_in_batch = true;
+    while((p_data < p_end) && (MESH_HCI_STATUS_SUCCESS == status))
+    {
+        if((uint32_t)(p_end - p_data) < MESH_HCI_BATCH_HDR_LEN)
+        {
+            status = MESH_HCI_STATUS_BAD_LENGTH;
+            break;
+        }
+        opcode = mesh_hci_cmd_get_u16(p_data);
+        param_len = p_data[2];
+        p_data += MESH_HCI_BATCH_HDR_LEN;
+        if((uint32_t)(p_end - p_data) < param_len)
+        {
+            status = MESH_HCI_STATUS_BAD_LENGTH;
+            break;
+        }
+
+        status = mesh_hci_cmd_dispatch(opcode, p_data, param_len, true);
+        p_data += param_len;
+    }
+    hci_cmd_in_batch = false;
+    return status;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_hci_cmd_is_app_opcode
+ *******************************************************************************
+ * Summary:
+ *  Check if an opcode belongs to the switch command group.
+ *
+ * Parameters:
+ *  uint16_t opcode : HCI command opcode
+ *
+ * Return:
+ *  bool : true for a switch command
+ *
+ ******************************************************************************/
+bool mesh_hci_cmd_is_app_opcode(uint16_t opcode)
+{
+    return MESH_HCI_CMD_GROUP == (opcode >> 8);
+}
+
+/*******************************************************************************
+ * Function Name: mesh_hci_cmd_handle
+ *******************************************************************************
+ * Summary:
+ *  Run a command frame received from the host MCU and answer it with one
+ *  MESH_HCI_EVT_STATUS event.
+ *
+ * Parameters:
+ *  uint16_t opcode : HCI command opcode
+ *  const uint8_t *p_data : command parameters
+ *  uint32_t length : length of the parameters
+ *
+ * Return:
+ *  uint8_t : MESH_HCI_STATUS_*
+ *
+ ******************************************************************************/
+uint8_t mesh_hci_cmd_handle(uint16_t opcode, const uint8_t *p_data, uint32_t length)
+{
+    uint32_t commands = hci_cmd_stats.commands;
+    uint8_t event[4];
+    uint8_t status;
+
+    hci_cmd_stats.frames++;
+    status = mesh_hci_cmd_dispatch(opcode, p_data, length, false);
+
+    event[0] = (uint8_t)opcode;
+    event[1] = (uint8_t)(opcode >> 8);
+    event[2] = status;
+    event[3] = (uint8_t)(hci_cmd_stats.commands - commands);
+    mesh_application_send_hci_event(MESH_HCI_EVT_STATUS, event, sizeof(event));
+
+    return status;
+}
@@ -0,0 +1,114 @@
+/*******************************************************************************
+* File Name: mesh_hci_cmd.h
+*
+* Description: This file is the public interface of mesh_hci_cmd.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef MESH_HCI_CMD_H_
+#define MESH_HCI_CMD_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "stdint.h"
+#include "stdbool.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Host MCU commands of the switch. All fields are little endian.
+ *
+ * LEVEL_SET     dst(2) level(2) transition_ms(4) delay_ms(2) flags(1)
+ *               dst 0 sends to the fan-out destinations, flags bit 0 is final
+ * FANOUT_SET    dst(2) * n, n up to MESH_FANOUT_MAX_DST, n = 0 uses the publication
+ * SCENE_RECALL  scene(2)
+ * CONFIG        key(1) value(n), see MESH_HCI_CFG_*
+ * STATS_GET     no parameters, answered by MESH_HCI_EVT_STATS
+ * RUNTIME_STATS flags(1), answered by MESH_HCI_EVT_RUNTIME_STATS with the
+ *               runtime_stats_serialize() blob, flags bit 0 also prints the
+ *               statistics on the debug UART, bit 1 is reserved, bit 2
+ *               prints the FreeRTOS heap allocation trace, bit 3 benchmarks the trace levels, bit 4
+ *               benchmarks the friend queues (not on a low power node).
+ *               The benchmarks run in a low priority task and are answered
+ *               later by MESH_HCI_EVT_BENCHMARK: flags(1), then result(4) for
+ *               each benchmark flag set, lowest bit first. A benchmark flag
+ *               is rejected inside a batch or while a benchmark runs.
+ *               ENABLE_RUNTIME_STATS builds only
+ * BATCH         { opcode(2) length(1) parameters(length) } repeated
+ *
+ * Every frame is answered by one MESH_HCI_EVT_STATUS: opcode(2) status(1)
+ * executed(1). For a batch the status is the one of the first failed command
+ * and executed is the number of commands run before it. */
+#define MESH_HCI_CMD_GROUP                  (0xE0u)
+#define MESH_HCI_CMD_OPCODE(code)           ((uint16_t)((MESH_HCI_CMD_GROUP << 8) | (code)))
+
+#define MESH_HCI_CMD_LEVEL_SET              MESH_HCI_CMD_OPCODE(0x01u)
+#define MESH_HCI_CMD_FANOUT_SET             MESH_HCI_CMD_OPCODE(0x02u)
+#define MESH_HCI_CMD_SCENE_RECALL           MESH_HCI_CMD_OPCODE(0x03u)
+#define MESH_HCI_CMD_CONFIG                 MESH_HCI_CMD_OPCODE(0x04u)
+#define MESH_HCI_CMD_STATS_GET              MESH_HCI_CMD_OPCODE(0x05u)
+#define MESH_HCI_CMD_BATCH                  MESH_HCI_CMD_OPCODE(0x06u)
+#define MESH_HCI_CMD_RUNTIME_STATS          MESH_HCI_CMD_OPCODE(0x07u)
+
+#define MESH_HCI_EVT_STATUS                 MESH_HCI_CMD_OPCODE(0x81u)
+#define MESH_HCI_EVT_STATS                  MESH_HCI_CMD_OPCODE(0x82u)
+#define MESH_HCI_EVT_RUNTIME_STATS          MESH_HCI_CMD_OPCODE(0x83u)
+#define MESH_HCI_EVT_BENCHMARK              MESH_HCI_CMD_OPCODE(0x84u)
+
+/* CONFIG keys */
+#define MESH_HCI_CFG_SHORT_PRESS            (0x01u) /* action(1) scene(2) */
+#define MESH_HCI_CFG_DOUBLE_PRESS           (0x02u) /* action(1) scene(2) */
+#define MESH_HCI_CFG_HCI_TRACE              (0x03u) /* enable(1), spy log builds only */
+#define MESH_HCI_CFG_TRACE_LEVEL            (0x04u) /* module(1) level(1), module 0xFF for all */
+
+/* Command status */
+#define MESH_HCI_STATUS_SUCCESS             (0x00u)
+#define MESH_HCI_STATUS_UNKNOWN_OPCODE      (0x01u)
+#define MESH_HCI_STATUS_BAD_LENGTH          (0x02u)
+#define MESH_HCI_STATUS_BAD_PARAM           (0x03u)
+#define MESH_HCI_STATUS_FAILED              (0x04u)
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+bool mesh_hci_cmd_is_app_opcode(uint16_t opcode);
+uint8_t mesh_hci_cmd_handle(uint16_t opcode, const uint8_t *p_data, uint32_t length);
+
+#endif /* MESH_HCI_CMD_H_ */
@@ -0,0 +1,381 @@
+/*******************************************************************************
+* File Name: mesh_lpn.c
+*
+* Description: Low Power Node profile of the switch. The button commands are
+*              held for a short time so that they share a wakeup with the next
+*              friend poll, and repeated level steps collapse into the latest
+*              one. The poll timeout adapts to how often the switch is used,
+*              and an energy model estimates the radio time and the battery
+*              life from the observed use.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "cy_retarget_io.h"
+#include "wiced_bt_mesh_core.h"
+#include "mesh_application.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "mesh_cfg.h"
+#include "mesh_app.h"
+#include "flash_utils.h"
+#include "mesh_lpn.h"
+
+#if defined(LOW_POWER_NODE) && (LOW_POWER_NODE == 1)
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* NVRAM record of the adapted poll timeout, after the fast power off counter */
+#define MESH_LPN_NVRAM_ID_OFFSET            (1u)
+
+#define MESH_LPN_MS_PER_DAY                 (86400000u)
+#define MESH_LPN_US_PER_HOUR                (3600000000ull)
+
+/*******************************************************************************
+ * Variables Definitions
+ ******************************************************************************/
+typedef struct
+{
+    uint32_t commands;                          /* button commands sent */
+    uint32_t sleeps;                            /* sleeps reported by the mesh core */
+} mesh_lpn_stats_t;
+
+static mesh_lpn_stats_t lpn_stats;
+
+static TickType_t lpn_start_tick = 0u;
+
+/* Use of the switch: commands closer than MESH_LPN_SESSION_GAP_MS are one session */
+static TickType_t lpn_last_command_tick = 0u;
+static TickType_t lpn_session_tick = 0u;
+static uint32_t lpn_session_interval_ms = 0u;   /* average time between sessions */
+
+/* Adapted poll timeout not yet written to the NVRAM */
+static bool lpn_poll_timeout_dirty = false;
+
+/*******************************************************************************
+ * Function Name: mesh_lpn_set_poll_timeout
+ *******************************************************************************
+ * Summary:
+ *  Set the poll timeout requested from the friend. The mesh core only sends
+ *  it in the Friend Request of the next friendship, the current friendship
+ *  keeps the poll timeout it was established with. It is written to the
+ *  NVRAM later by mesh_lpn_save(), off the button path.
+ *
+ * Parameters:
+ *  uint32_t poll_timeout : poll timeout in 100 ms units
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_lpn_set_poll_timeout(uint32_t poll_timeout)
+{
+    taskENTER_CRITICAL();
+    mesh_config.low_power.poll_timeout = poll_timeout;
+    lpn_poll_timeout_dirty = true;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: mesh_lpn_adapt
+ *******************************************************************************
+ * Summary:
+ *  Track the time between the sessions of use and adapt the poll timeout so
+ *  that MESH_LPN_POLLS_PER_SESSION polls fall between two sessions on
+ *  average. The levels cached from the status messages the friend holds are
+ *  then fresh at the next use, while an idle switch polls rarely. The poll
+ *  timeout is only changed by more than a quarter, to spare the flash.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_lpn_adapt(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    uint32_t gap_ms = (uint32_t)(now - lpn_last_command_tick) * portTICK_PERIOD_MS;
+    uint32_t interval_ms;
+    uint32_t current = mesh_config.low_power.poll_timeout;
+    uint32_t target;
+
+    lpn_last_command_tick = now;
+    if((0u != lpn_session_tick) && (gap_ms < MESH_LPN_SESSION_GAP_MS))
+    {
+        return;
+    }
+
+    if(0u != lpn_session_tick)
+    {
+        interval_ms = (uint32_t)(now - lpn_session_tick) * portTICK_PERIOD_MS;
+        lpn_session_interval_ms = (0u == lpn_session_interval_ms) ? interval_ms :
+                                  ((lpn_session_interval_ms / 8u) * 7u) + (interval_ms / 8u);
+
+        target = lpn_session_interval_ms / (100u * MESH_LPN_POLLS_PER_SESSION);
+        if(target < MESH_LPN_POLL_TIMEOUT_MIN)
+        {
+            target = MESH_LPN_POLL_TIMEOUT_MIN;
+        }
+        else if(target > MESH_LPN_POLL_TIMEOUT_MAX)
+        {
+            target = MESH_LPN_POLL_TIMEOUT_MAX;
+        }
+        if((target > (current + (current / 4u))) || ((target + (target / 4u)) < current))
+        {
+            mesh_lpn_set_poll_timeout(target);
+        }
+    }
+    lpn_session_tick = now;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_lpn_send_level
+ *******************************************************************************
+ * Summary:
+ *  Send a level command of the button right away, and track the use of the
+ *  switch for the poll timeout. The commands are not held for a friend poll:
+ *  the polls are seconds apart, far beyond the latency a switch can add.
+ *
+ * Parameters:
+ *  bool is_instant : instant flag
+ *  bool is_final : final flag
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void mesh_lpn_send_level(bool is_instant, bool is_final)
+{
+    mesh_lpn_adapt();
+    lpn_stats.commands++;
+    mesh_dimmer_set_level(is_instant, is_final);
+}
+
+/*******************************************************************************
+ * Function Name: mesh_lpn_send_scene
+ *******************************************************************************
+ * Summary:
+ *  Send a scene recall of the button right away, and track the use of the
+ *  switch for the poll timeout.
+ *
+ * Parameters:
+ *  uint16_t scene_number : scene to recall
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void mesh_lpn_send_scene(uint16_t scene_number)
+{
+    mesh_lpn_adapt();
+    lpn_stats.commands++;
+    mesh_dimmer_scene_recall(scene_number);
+}
+
+/*******************************************************************************
+ * Function Name: mesh_lpn_sleep
+ *******************************************************************************
+ * Summary:
+ *  LPN sleep callback of the mesh application library. The sleeps count the
+ *  polls for the energy estimate.
+ *
+ * Parameters:
+ *  uint32_t duration : time to the next poll in milliseconds
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void mesh_lpn_sleep(uint32_t duration)
+{
+    (void)duration;
+
+    taskENTER_CRITICAL();
+    lpn_stats.sleeps++;
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: mesh_lpn_save
+ *******************************************************************************
+ * Summary:
+ *  Write an adapted poll timeout to the NVRAM, so it is kept across resets.
+ *  Called by the board task after a button event, the flash write stays off
+ *  the button and timer paths.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void mesh_lpn_save(void)
+{
+    uint32_t poll_timeout;
+    bool is_dirty;
+    wiced_result_t rslt;
+
+    taskENTER_CRITICAL();
+    is_dirty = lpn_poll_timeout_dirty;
+    lpn_poll_timeout_dirty = false;
+    poll_timeout = mesh_config.low_power.poll_timeout;
+    taskEXIT_CRITICAL();
+
+    if(!is_dirty)
+    {
+        return;
+    }
+    if(sizeof(poll_timeout) != flash_memory_write(mesh_application_get_nvram_id_app_start() + MESH_LPN_NVRAM_ID_OFFSET,
+                                                  sizeof(poll_timeout), (uint8_t *)&poll_timeout, &rslt))
+    {
+        printf("LPN poll timeout write flash failed\n");
+    }
+    printf("LPN poll timeout %ld00ms requested from the next friendship, the current one is unchanged\n", poll_timeout);
+    mesh_lpn_print();
+}
+
+/*******************************************************************************
+ * Function Name: mesh_lpn_init
+ *******************************************************************************
+ * Summary:
+ *  Restore the adapted poll timeout before the mesh core starts.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void mesh_lpn_init(void)
+{
+    uint32_t poll_timeout;
+    wiced_result_t rslt;
+
+    if((sizeof(poll_timeout) == flash_memory_read(mesh_application_get_nvram_id_app_start() + MESH_LPN_NVRAM_ID_OFFSET,
+                                                  sizeof(poll_timeout), (uint8_t *)&poll_timeout, &rslt)) &&
+       (poll_timeout >= MESH_LPN_POLL_TIMEOUT_MIN) && (poll_timeout <= MESH_LPN_POLL_TIMEOUT_MAX))
+    {
+        mesh_config.low_power.poll_timeout = poll_timeout;
+    }
+
+    lpn_start_tick = xTaskGetTickCount();
+    printf("LPN poll timeout %ld00ms\n", mesh_config.low_power.poll_timeout);
+}
+
+/*******************************************************************************
+ * Function Name: mesh_lpn_get_estimate
+ *******************************************************************************
+ * Summary:
+ *  Extrapolate the polls and commands since boot to a day and estimate the
+ *  radio time and the charge drawn. A poll is one advertising transmission
+ *  and a receive window, a command is sent MESH_TX_UNACK_RETRANS_CNT + 1
+ *  times. The polls are counted from the sleeps reported by the mesh core,
+ *  before the first hour the requested poll timeout is used instead.
+ *
+ * Parameters:
+ *  mesh_lpn_estimate_t *p_estimate : estimate
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void mesh_lpn_get_estimate(mesh_lpn_estimate_t *p_estimate)
+{
+    uint32_t elapsed_ms = (uint32_t)(xTaskGetTickCount() - lpn_start_tick) * portTICK_PERIOD_MS;
+    uint64_t tx_us;
+    uint64_t rx_us;
+    uint64_t charge;
+
+    p_estimate->poll_timeout = mesh_config.low_power.poll_timeout;
+    if(elapsed_ms < (MESH_LPN_MS_PER_DAY / 24u))
+    {
+        p_estimate->polls_per_day = MESH_LPN_MS_PER_DAY / (p_estimate->poll_timeout * 100u);
+        p_estimate->commands_per_day = 0u;
+    }
+    else
+    {
+        p_estimate->polls_per_day = (uint32_t)(((uint64_t)lpn_stats.sleeps * MESH_LPN_MS_PER_DAY) / elapsed_ms);
+        p_estimate->commands_per_day = (uint32_t)(((uint64_t)lpn_stats.commands * MESH_LPN_MS_PER_DAY) / elapsed_ms);
+    }
+
+    tx_us = (uint64_t)p_estimate->polls_per_day * MESH_LPN_ADV_PDU_US * MESH_LPN_ADV_CHANNELS;
+    tx_us += (uint64_t)p_estimate->commands_per_day * MESH_LPN_ADV_PDU_US * MESH_LPN_ADV_CHANNELS *
+             (MESH_TX_UNACK_RETRANS_CNT + 1u);
+    rx_us = (uint64_t)p_estimate->polls_per_day * MESH_LPN_RX_WINDOW_MS * 1000u;
+
+    p_estimate->radio_tx_ms_per_day = (uint32_t)(tx_us / 1000u);
+    p_estimate->radio_rx_ms_per_day = (uint32_t)(rx_us / 1000u);
+
+    charge = ((tx_us * MESH_LPN_TX_CURRENT_UA) + (rx_us * MESH_LPN_RX_CURRENT_UA)) / MESH_LPN_US_PER_HOUR;
+    charge += MESH_LPN_SLEEP_CURRENT_UA * 24u;
+    p_estimate->charge_uah_per_day = (uint32_t)charge;
+    p_estimate->battery_days = (uint32_t)(((uint64_t)MESH_LPN_BATTERY_MAH * 1000u) / charge);
+}
+
+/*******************************************************************************
+ * Function Name: mesh_lpn_print
+ *******************************************************************************
+ * Summary:
+ *  Print the command counter and the energy estimate.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void mesh_lpn_print(void)
+{
+    mesh_lpn_estimate_t estimate;
+
+    mesh_lpn_get_estimate(&estimate);
+    printf("LPN requested poll timeout %ld00ms, button commands %ld\n", estimate.poll_timeout, lpn_stats.commands);
+    printf("LPN per day: %ld polls, %ld commands, radio tx %ldms rx %ldms, %ld uAh, battery %ld days\n",
+           estimate.polls_per_day, estimate.commands_per_day, estimate.radio_tx_ms_per_day,
+           estimate.radio_rx_ms_per_day, estimate.charge_uah_per_day, estimate.battery_days);
+}
+
+#endif /* LOW_POWER_NODE */
+
+/* [] END OF FILE */
@@ -0,0 +1,78 @@
+/*******************************************************************************
+* File Name: mesh_lpn.h
+*
+* Description: This file is the public interface of mesh_lpn.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef MESH_LPN_H_
+#define MESH_LPN_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "stdint.h"
+#include "stdbool.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+/* Daily figures extrapolated from the use since boot */
+typedef struct
+{
+    uint32_t poll_timeout;                      /* requested from the friend, 100 ms units */
+    uint32_t polls_per_day;
+    uint32_t commands_per_day;                  /* mesh messages sent for button commands */
+    uint32_t radio_tx_ms_per_day;
+    uint32_t radio_rx_ms_per_day;
+    uint32_t charge_uah_per_day;                /* radio and sleep current */
+    uint32_t battery_days;
+} mesh_lpn_estimate_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void mesh_lpn_init(void);
+void mesh_lpn_sleep(uint32_t duration);
+void mesh_lpn_send_level(bool is_instant, bool is_final);
+void mesh_lpn_send_scene(uint16_t scene_number);
+void mesh_lpn_save(void);
+void mesh_lpn_get_estimate(mesh_lpn_estimate_t *p_estimate);
+void mesh_lpn_print(void);
+
+#endif /* MESH_LPN_H_ */
@@ -0,0 +1,512 @@
+/*******************************************************************************
+* File Name: rtos_heap.c
+*
+* Description: This file contains the FreeRTOS heap selected with RTOS_HEAP
+*              when it is not provided by the FreeRTOS library (TLSF), and the
+*              statistics shared by all the heaps: free space, largest free
+*              block, fragmentation and, with ENABLE_HEAP_STATS, allocation
+*              latency percentiles and an allocation trace that can be
+*              replayed on a host with tools/heap_replay.c.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "cybsp.h"
+#include "cy_retarget_io.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stdbool.h"
+#include <malloc.h>
+#include <string.h>
+#include "tlsf_heap.h"
+#include "rtos_heap.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define RTOS_HEAP_HIST_BUCKETS          (32u)
+#ifndef RTOS_HEAP_TRACE_LEN
+#define RTOS_HEAP_TRACE_LEN             (256u)  /* records captured from start-up */
+#endif
+
+/*******************************************************************************
+ * Variables Definitions
+ ******************************************************************************/
+#if (RTOS_HEAP == RTOS_HEAP_TLSF)
+static uint64_t rtos_heap_arena[configTOTAL_HEAP_SIZE / sizeof(uint64_t)];
+static tlsf_heap_t rtos_tlsf;
+static bool rtos_tlsf_ready = false;
+#endif
+
+static uint32_t rtos_heap_failed = 0u;
+
+#ifdef ENABLE_HEAP_STATS
+/* Latency histogram: bucket n counts the operations of 2^n to 2^(n+1)-1
+ * cycles */
+typedef struct
+{
+    uint32_t bucket[RTOS_HEAP_HIST_BUCKETS];
+    uint32_t count;
+    uint32_t max;
+} rtos_heap_hist_t;
+
+static rtos_heap_hist_t rtos_heap_alloc_hist;
+static rtos_heap_hist_t rtos_heap_free_hist;
+
+/* Allocation trace, a size of 0 is a release */
+typedef struct
+{
+    uint32_t ptr;
+    uint16_t size;
+    uint16_t cycles;                            /* saturated */
+} rtos_heap_trace_t;
+
+static rtos_heap_trace_t rtos_heap_trace[RTOS_HEAP_TRACE_LEN];
+static uint32_t rtos_heap_trace_count = 0u;
+
+void *__real_pvPortMalloc(size_t xWantedSize);
+void __real_vPortFree(void *pv);
+#endif
+
+#if (RTOS_HEAP == RTOS_HEAP_TLSF)
+/*******************************************************************************
+ * Function Name: pvPortMalloc
+ *******************************************************************************
+ * Summary:
+ *  FreeRTOS allocation from the TLSF heap. The scheduler is suspended during
+ *  the allocation, as in heap_4.
+ *
+ * Parameters:
+ *  size_t xWantedSize : requested bytes
+ *
+ * Return:
+ *  void * : buffer, NULL on failure
+ *
+ ******************************************************************************/
+void *pvPortMalloc(size_t xWantedSize)
+{
+    void *p_buf;
+
+    vTaskSuspendAll();
+    if(!rtos_tlsf_ready)
+    {
+        tlsf_heap_init(&rtos_tlsf, rtos_heap_arena, sizeof(rtos_heap_arena));
+        rtos_tlsf_ready = true;
+    }
+    p_buf = tlsf_heap_alloc(&rtos_tlsf, xWantedSize);
+    (void)xTaskResumeAll();
+
+#if (configUSE_MALLOC_FAILED_HOOK == 1)
+    if(NULL == p_buf)
+    {
+        extern void vApplicationMallocFailedHook(void);
+        vApplicationMallocFailedHook();
+    }
+#endif
+    return p_buf;
+}
+
+/*******************************************************************************
+ * Function Name: vPortFree
+ *******************************************************************************
+ * Summary:
+ *  FreeRTOS release to the TLSF heap.
+ *
+ * Parameters:
+ *  void *pv : buffer of pvPortMalloc(), or NULL
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void vPortFree(void *pv)
+{
+    if(NULL == pv)
+    {
+        return;
+    }
+    vTaskSuspendAll();
+    tlsf_heap_free(&rtos_tlsf, pv);
+    (void)xTaskResumeAll();
+}
+
+/*******************************************************************************
+ * Function Name: xPortGetFreeHeapSize
+ *******************************************************************************
+ * Summary:
+ *  Free bytes of the TLSF heap.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  size_t : free bytes
+ *
+ ******************************************************************************/
+size_t xPortGetFreeHeapSize(void)
+{
+    return rtos_tlsf_ready ? rtos_tlsf.free_bytes : sizeof(rtos_heap_arena);
+}
+
+/*******************************************************************************
+ * Function Name: xPortGetMinimumEverFreeHeapSize
+ *******************************************************************************
+ * Summary:
+ *  Lowest free bytes of the TLSF heap since start-up.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  size_t : free bytes
+ *
+ ******************************************************************************/
+size_t xPortGetMinimumEverFreeHeapSize(void)
+{
+    return rtos_tlsf_ready ? rtos_tlsf.min_free_bytes : sizeof(rtos_heap_arena);
+}
+#endif /* RTOS_HEAP == RTOS_HEAP_TLSF */
+
+#ifdef ENABLE_HEAP_STATS
+/*******************************************************************************
+ * Function Name: rtos_heap_cycles
+ *******************************************************************************
+ * Summary:
+ *  Read the DWT cycle counter, starting it on the first call. The first
+ *  allocations happen before any other user of the counter starts it.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  uint32_t : cycle count
+ *
+ ******************************************************************************/
+static uint32_t rtos_heap_cycles(void)
+{
+    if(0u == (DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk))
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    }
+    return DWT->CYCCNT;
+}
+
+/*******************************************************************************
+ * Function Name: rtos_heap_record
+ *******************************************************************************
+ * Summary:
+ *  Add an operation to the latency histogram and to the trace.
+ *
+ * Parameters:
+ *  rtos_heap_hist_t *p_hist : histogram of the operation
+ *  void *ptr : buffer
+ *  size_t size : requested bytes, 0 for a release
+ *  uint32_t cycles : duration of the operation
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void rtos_heap_record(rtos_heap_hist_t *p_hist, void *ptr, size_t size, uint32_t cycles)
+{
+    uint32_t bucket = (0u == cycles) ? 0u : (31u - (uint32_t)__builtin_clz(cycles));
+
+    taskENTER_CRITICAL();
+    p_hist->bucket[bucket]++;
+    p_hist->count++;
+    if(cycles > p_hist->max)
+    {
+        p_hist->max = cycles;
+    }
+    if(rtos_heap_trace_count < RTOS_HEAP_TRACE_LEN)
+    {
+        rtos_heap_trace[rtos_heap_trace_count].ptr = (uint32_t)ptr;
+        rtos_heap_trace[rtos_heap_trace_count].size = (size > UINT16_MAX) ? UINT16_MAX : (uint16_t)size;
+        rtos_heap_trace[rtos_heap_trace_count].cycles = (cycles > UINT16_MAX) ? UINT16_MAX : (uint16_t)cycles;
+        rtos_heap_trace_count++;
+    }
+    taskEXIT_CRITICAL();
+}
+
+/*******************************************************************************
+ * Function Name: __wrap_pvPortMalloc
+ *******************************************************************************
+ * Summary:
+ *  Measured FreeRTOS allocation, the linker routes pvPortMalloc() here with
+ *  ENABLE_HEAP_STATS.
+ *
+ * Parameters:
+ *  size_t xWantedSize : requested bytes
+ *
+ * Return:
+ *  void * : buffer, NULL on failure
+ *
+ ******************************************************************************/
+void *__wrap_pvPortMalloc(size_t xWantedSize)
+{
+    uint32_t start = rtos_heap_cycles();
+    void *p_buf = __real_pvPortMalloc(xWantedSize);
+
+    rtos_heap_record(&rtos_heap_alloc_hist, p_buf, xWantedSize, rtos_heap_cycles() - start);
+    if(NULL == p_buf)
+    {
+        rtos_heap_failed++;
+    }
+    return p_buf;
+}
+
+/*******************************************************************************
+ * Function Name: __wrap_vPortFree
+ *******************************************************************************
+ * Summary:
+ *  Measured FreeRTOS release, recorded with the scheduler suspended.
+ *
+ * Parameters:
+ *  void *pv : buffer of pvPortMalloc(), or NULL
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void __wrap_vPortFree(void *pv)
+{
+    uint32_t start;
+    uint32_t cycles;
+
+    /* The release is recorded before another task can allocate the buffer
+     * again, so the trace keeps the order of the heap operations */
+    vTaskSuspendAll();
+    start = rtos_heap_cycles();
+    __real_vPortFree(pv);
+    cycles = rtos_heap_cycles() - start;
+    if(NULL != pv)
+    {
+        rtos_heap_record(&rtos_heap_free_hist, pv, 0u, cycles);
+    }
+    (void)xTaskResumeAll();
+}
+
+/*******************************************************************************
+ * Function Name: rtos_heap_percentiles
+ *******************************************************************************
+ * Summary:
+ *  Latency percentiles of a histogram.
+ *
+ * Parameters:
+ *  const rtos_heap_hist_t *p_hist : histogram
+ *  rtos_heap_latency_t *p_latency : filled with the percentiles
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void rtos_heap_percentiles(const rtos_heap_hist_t *p_hist, rtos_heap_latency_t *p_latency)
+{
+    static const uint32_t permille[3] = { 500u, 900u, 990u };
+    uint32_t *p_out[3] = { &p_latency->p50, &p_latency->p90, &p_latency->p99 };
+    uint32_t seen = 0u;
+    uint32_t bucket = 0u;
+
+    p_latency->count = p_hist->count;
+    p_latency->max = p_hist->max;
+    for(uint32_t i = 0u; i < 3u; i++)
+    {
+        /* Smallest bucket reaching the share of the operations */
+        while((bucket < RTOS_HEAP_HIST_BUCKETS) &&
+              (((uint64_t)(seen + p_hist->bucket[bucket]) * 1000u) < ((uint64_t)p_hist->count * permille[i])))
+        {
+            seen += p_hist->bucket[bucket];
+            bucket++;
+        }
+        *p_out[i] = (0u == p_hist->count) ? 0u : ((2uL << bucket) - 1u);
+        if(*p_out[i] > p_hist->max)
+        {
+            *p_out[i] = p_hist->max;
+        }
+    }
+}
+#endif /* ENABLE_HEAP_STATS */
+
+/*******************************************************************************
+ * Function Name: rtos_heap_name
+ *******************************************************************************
+ * Summary:
+ *  Name of the heap selected with RTOS_HEAP.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  const char * : heap name
+ *
+ ******************************************************************************/
+const char *rtos_heap_name(void)
+{
+#if (RTOS_HEAP == RTOS_HEAP_TLSF)
+    return "TLSF";
+#elif (RTOS_HEAP == RTOS_HEAP_HEAP4)
+    return "heap_4";
+#else
+    return "malloc";
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: rtos_heap_get_stats
+ *******************************************************************************
+ * Summary:
+ *  Get the usage of the FreeRTOS heap. The C library heap does not report
+ *  its largest free block, the fragmentation is unknown there.
+ *
+ * Parameters:
+ *  rtos_heap_stats_t *p_stats : filled with the usage
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void rtos_heap_get_stats(rtos_heap_stats_t *p_stats)
+{
+#if (RTOS_HEAP == RTOS_HEAP_HEAP4)
+    HeapStats_t heap_stats;
+#elif (RTOS_HEAP != RTOS_HEAP_TLSF)
+    struct mallinfo heap_info;
+#endif
+
+    memset(p_stats, 0, sizeof(*p_stats));
+
+#if (RTOS_HEAP == RTOS_HEAP_TLSF)
+    vTaskSuspendAll();
+    p_stats->size = rtos_tlsf.size;
+    p_stats->free_bytes = rtos_tlsf.free_bytes;
+    p_stats->min_free_bytes = rtos_tlsf.min_free_bytes;
+    p_stats->largest_free = tlsf_heap_largest_free(&rtos_tlsf);
+    (void)xTaskResumeAll();
+#elif (RTOS_HEAP == RTOS_HEAP_HEAP4)
+    vPortGetHeapStats(&heap_stats);
+    p_stats->size = configTOTAL_HEAP_SIZE;
+    p_stats->free_bytes = heap_stats.xAvailableHeapSpaceInBytes;
+    p_stats->min_free_bytes = heap_stats.xMinimumEverFreeBytesRemaining;
+    p_stats->largest_free = heap_stats.xSizeOfLargestFreeBlockInBytes;
+#else
+    heap_info = mallinfo();
+    p_stats->size = (uint32_t)heap_info.arena;
+    p_stats->free_bytes = (uint32_t)heap_info.fordblks;
+#endif
+
+    if(0u == p_stats->largest_free)
+    {
+        p_stats->frag_permille = RTOS_HEAP_FRAG_UNKNOWN;
+    }
+    else
+    {
+        p_stats->frag_permille = (uint16_t)(1000u - (((uint64_t)p_stats->largest_free * 1000u) / p_stats->free_bytes));
+    }
+    p_stats->failed = rtos_heap_failed;
+
+#ifdef ENABLE_HEAP_STATS
+    taskENTER_CRITICAL();
+    rtos_heap_percentiles(&rtos_heap_alloc_hist, &p_stats->alloc);
+    rtos_heap_percentiles(&rtos_heap_free_hist, &p_stats->free);
+    taskEXIT_CRITICAL();
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: rtos_heap_print
+ *******************************************************************************
+ * Summary:
+ *  Print the usage of the FreeRTOS heap.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void rtos_heap_print(void)
+{
+    rtos_heap_stats_t stats;
+
+    rtos_heap_get_stats(&stats);
+    printf("FreeRTOS heap (%s): %ld of %ld bytes free, lowest %ld, largest block %ld\n", rtos_heap_name(),
+           stats.free_bytes, stats.size, stats.min_free_bytes, stats.largest_free);
+    if(RTOS_HEAP_FRAG_UNKNOWN != stats.frag_permille)
+    {
+        printf("  fragmentation: %d.%d%%\n", stats.frag_permille / 10u, stats.frag_permille % 10u);
+    }
+#ifdef ENABLE_HEAP_STATS
+    printf("  alloc cycles: p50 %ld p90 %ld p99 %ld max %ld over %ld, failed %ld\n", stats.alloc.p50,
+           stats.alloc.p90, stats.alloc.p99, stats.alloc.max, stats.alloc.count, stats.failed);
+    printf("  free cycles: p50 %ld p90 %ld p99 %ld max %ld over %ld\n", stats.free.p50, stats.free.p90,
+           stats.free.p99, stats.free.max, stats.free.count);
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: rtos_heap_trace_dump
+ *******************************************************************************
+ * Summary:
+ *  Print the allocation trace captured since start-up, one "HT" line per
+ *  operation: pointer, requested bytes (0 for a release) and cycles. The
+ *  lines are the input of tools/heap_replay.c.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void rtos_heap_trace_dump(void)
+{
+#ifdef ENABLE_HEAP_STATS
+    printf("HT begin %s %ld\n", rtos_heap_name(), (uint32_t)configTOTAL_HEAP_SIZE);
+    for(uint32_t i = 0u; i < rtos_heap_trace_count; i++)
+    {
+        printf("HT %08lx %d %d\n", rtos_heap_trace[i].ptr, rtos_heap_trace[i].size, rtos_heap_trace[i].cycles);
+    }
+    printf("HT end\n");
+#else
+    printf("Heap trace needs ENABLE_HEAP_STATS\n");
+#endif
+}
+
+/* [] END OF FILE */
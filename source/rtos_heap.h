@@ -0,0 +1,90 @@
+/*******************************************************************************
+* File Name: rtos_heap.h
+*
+* Description: This file is the public interface of rtos_heap.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef RTOS_HEAP_H_
+#define RTOS_HEAP_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "stdint.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define RTOS_HEAP_FRAG_UNKNOWN          (0xFFFFu)
+
+/* Latency percentiles in CPU cycles, 0 without ENABLE_HEAP_STATS. The
+ * percentiles come from a power of two histogram, they are the upper bound
+ * of their bucket. */
+typedef struct
+{
+    uint32_t count;
+    uint32_t p50;
+    uint32_t p90;
+    uint32_t p99;
+    uint32_t max;
+} rtos_heap_latency_t;
+
+/* Usage of the FreeRTOS heap, whatever engine RTOS_HEAP selects */
+typedef struct
+{
+    uint32_t size;                              /* bytes managed by the engine */
+    uint32_t free_bytes;
+    uint32_t min_free_bytes;                    /* 0 when the engine does not track it */
+    uint32_t largest_free;                      /* 0 when the engine cannot tell */
+    uint16_t frag_permille;                     /* free bytes outside the largest block */
+    uint32_t failed;                            /* allocations that returned NULL, ENABLE_HEAP_STATS only */
+    rtos_heap_latency_t alloc;
+    rtos_heap_latency_t free;
+} rtos_heap_stats_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+const char *rtos_heap_name(void);
+void rtos_heap_get_stats(rtos_heap_stats_t *p_stats);
+void rtos_heap_print(void);
+void rtos_heap_trace_dump(void);
+
+#endif /* RTOS_HEAP_H_ */
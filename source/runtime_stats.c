@@ -0,0 +1,323 @@
+/*******************************************************************************
+* File Name: runtime_stats.c
+*
+* Description: This file contains the run time statistics used to size the
+*              memory of the application: CPU time and stack high-water mark
+*              of every task, and the use of the mesh heap and of the heap
+*              behind the FreeRTOS allocations. The CPU time is counted with
+*              the DWT cycle counter.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+#ifdef ENABLE_RUNTIME_STATS
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "cybsp.h"
+#include "cy_retarget_io.h"
+#include "wiced_memory.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <string.h>
+#include "rtos_heap.h"
+#include "runtime_stats.h"
+
+/*******************************************************************************
+ * Variables Definitions
+ ******************************************************************************/
+extern wiced_bt_heap_t* p_mesh_heap;
+
+/* 64 bit extension of the cycle counter. The counter is read at every
+ * context switch, far more often than it wraps. */
+static uint32_t cycles_last = 0u;
+static uint32_t cycles_high = 0u;
+
+/* Run time counters of the previous sample, by task number */
+typedef struct
+{
+    uint32_t counter;
+    uint32_t task_run_time[RUNTIME_STATS_MAX_TASKS];
+    UBaseType_t task_number[RUNTIME_STATS_MAX_TASKS];
+    UBaseType_t num_tasks;
+} runtime_stats_prev_t;
+
+static runtime_stats_prev_t prev_sample;
+
+static TaskStatus_t task_status[RUNTIME_STATS_MAX_TASKS];
+
+/*******************************************************************************
+ * Function Name: runtime_stats_timer_init
+ *******************************************************************************
+ * Summary:
+ *  Start the DWT cycle counter used as the run time counter. Called by
+ *  FreeRTOS when the scheduler starts. The counter is not cleared, the boot
+ *  profiler may already use it.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void runtime_stats_timer_init(void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    cycles_last = DWT->CYCCNT;
+}
+
+/*******************************************************************************
+ * Function Name: runtime_stats_counter
+ *******************************************************************************
+ * Summary:
+ *  Run time counter of FreeRTOS. The cycle counter stops in deep sleep, so
+ *  the idle time spent there is not counted.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  uint32_t : cycles divided by 2^RUNTIME_STATS_SHIFT
+ *
+ ******************************************************************************/
+uint32_t runtime_stats_counter(void)
+{
+    uint32_t cycles = DWT->CYCCNT;
+
+    if(cycles < cycles_last)
+    {
+        cycles_high++;
+    }
+    cycles_last = cycles;
+
+    return (uint32_t)((((uint64_t)cycles_high << 32) | cycles) >> RUNTIME_STATS_SHIFT);
+}
+
+/*******************************************************************************
+ * Function Name: runtime_stats_prev_run_time
+ *******************************************************************************
+ * Summary:
+ *  Run time counter of a task at the previous sample.
+ *
+ * Parameters:
+ *  UBaseType_t task_number : FreeRTOS task number
+ *
+ * Return:
+ *  uint32_t : run time counter, 0 for a task created since
+ *
+ ******************************************************************************/
+static uint32_t runtime_stats_prev_run_time(UBaseType_t task_number)
+{
+    for(UBaseType_t i = 0u; i < prev_sample.num_tasks; i++)
+    {
+        if(prev_sample.task_number[i] == task_number)
+        {
+            return prev_sample.task_run_time[i];
+        }
+    }
+    return 0u;
+}
+
+/*******************************************************************************
+ * Function Name: runtime_stats_sample
+ *******************************************************************************
+ * Summary:
+ *  Take a sample of the statistics. The CPU shares cover the time since the
+ *  previous sample, or since the scheduler start for the first one.
+ *
+ * Parameters:
+ *  runtime_stats_t *p_stats : filled with the sample
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void runtime_stats_sample(runtime_stats_t *p_stats)
+{
+    wiced_bt_heap_statistics_t heap_stats;
+    rtos_heap_stats_t rtos_stats;
+    uint32_t total_run_time;
+    uint32_t window;
+    uint32_t run_time;
+    UBaseType_t num_tasks;
+
+    memset(p_stats, 0, sizeof(*p_stats));
+
+    num_tasks = uxTaskGetSystemState(task_status, RUNTIME_STATS_MAX_TASKS, &total_run_time);
+    if(0u == num_tasks)
+    {
+        printf("Runtime stats: more than %d tasks\n", RUNTIME_STATS_MAX_TASKS);
+    }
+
+    window = total_run_time - prev_sample.counter;
+    p_stats->window_us = (uint32_t)(((uint64_t)window << RUNTIME_STATS_SHIFT) / (SystemCoreClock / 1000000u));
+    p_stats->num_tasks = (uint8_t)num_tasks;
+
+    for(UBaseType_t i = 0u; i < num_tasks; i++)
+    {
+        run_time = task_status[i].ulRunTimeCounter - runtime_stats_prev_run_time(task_status[i].xTaskNumber);
+        strncpy(p_stats->task[i].name, task_status[i].pcTaskName, RUNTIME_STATS_NAME_LEN);
+        p_stats->task[i].cpu_permille = (0u == window) ? 0u : (uint16_t)(((uint64_t)run_time * 1000u) / window);
+        p_stats->task[i].stack_free_words = (uint16_t)task_status[i].usStackHighWaterMark;
+        p_stats->task[i].priority = (uint8_t)task_status[i].uxCurrentPriority;
+
+        prev_sample.task_number[i] = task_status[i].xTaskNumber;
+        prev_sample.task_run_time[i] = task_status[i].ulRunTimeCounter;
+    }
+    prev_sample.num_tasks = num_tasks;
+    prev_sample.counter = total_run_time;
+
+    if((NULL != p_mesh_heap) && wiced_bt_get_heap_statistics(p_mesh_heap, &heap_stats))
+    {
+        p_stats->mesh_heap_size = heap_stats.heap_size;
+        p_stats->mesh_heap_used = heap_stats.current_size_allocated;
+        p_stats->mesh_heap_peak = heap_stats.max_heap_size_used;
+        p_stats->mesh_heap_largest_free = heap_stats.current_largest_free_size;
+    }
+
+    rtos_heap_get_stats(&rtos_stats);
+    p_stats->rtos_heap_size = rtos_stats.size;
+    p_stats->rtos_heap_used = rtos_stats.size - rtos_stats.free_bytes;
+}
+
+/*******************************************************************************
+ * Function Name: runtime_stats_put_u32
+ *******************************************************************************
+ * Summary:
+ *  Write a little endian 32 bit field to the blob.
+ *
+ * Parameters:
+ *  uint8_t *p : field
+ *  uint32_t value : value
+ *
+ * Return:
+ *  uint8_t * : next field
+ *
+ ******************************************************************************/
+static uint8_t *runtime_stats_put_u32(uint8_t *p, uint32_t value)
+{
+    p[0] = (uint8_t)value;
+    p[1] = (uint8_t)(value >> 8);
+    p[2] = (uint8_t)(value >> 16);
+    p[3] = (uint8_t)(value >> 24);
+    return p + 4;
+}
+
+/*******************************************************************************
+ * Function Name: runtime_stats_serialize
+ *******************************************************************************
+ * Summary:
+ *  Write a sample as a little endian binary blob:
+ *  version(1) num_tasks(1) window_us(4) mesh heap size(4) used(4) peak(4)
+ *  largest free(4) FreeRTOS heap size(4) used(4), then for every task
+ *  name(RUNTIME_STATS_NAME_LEN) cpu_permille(2) stack_free_words(2) priority(1).
+ *
+ * Parameters:
+ *  const runtime_stats_t *p_stats : sample
+ *  uint8_t *p_buf : blob
+ *  uint32_t size : size of the blob buffer
+ *
+ * Return:
+ *  uint32_t : length of the blob, 0 if the buffer is too small
+ *
+ ******************************************************************************/
+uint32_t runtime_stats_serialize(const runtime_stats_t *p_stats, uint8_t *p_buf, uint32_t size)
+{
+    uint8_t *p = p_buf;
+
+    if(size < (RUNTIME_STATS_BLOB_HDR_LEN + (p_stats->num_tasks * RUNTIME_STATS_BLOB_TASK_LEN)))
+    {
+        return 0u;
+    }
+
+    *p++ = RUNTIME_STATS_BLOB_VERSION;
+    *p++ = p_stats->num_tasks;
+    p = runtime_stats_put_u32(p, p_stats->window_us);
+    p = runtime_stats_put_u32(p, p_stats->mesh_heap_size);
+    p = runtime_stats_put_u32(p, p_stats->mesh_heap_used);
+    p = runtime_stats_put_u32(p, p_stats->mesh_heap_peak);
+    p = runtime_stats_put_u32(p, p_stats->mesh_heap_largest_free);
+    p = runtime_stats_put_u32(p, p_stats->rtos_heap_size);
+    p = runtime_stats_put_u32(p, p_stats->rtos_heap_used);
+
+    for(uint8_t i = 0u; i < p_stats->num_tasks; i++)
+    {
+        memcpy(p, p_stats->task[i].name, RUNTIME_STATS_NAME_LEN);
+        p += RUNTIME_STATS_NAME_LEN;
+        *p++ = (uint8_t)p_stats->task[i].cpu_permille;
+        *p++ = (uint8_t)(p_stats->task[i].cpu_permille >> 8);
+        *p++ = (uint8_t)p_stats->task[i].stack_free_words;
+        *p++ = (uint8_t)(p_stats->task[i].stack_free_words >> 8);
+        *p++ = p_stats->task[i].priority;
+    }
+
+    return (uint32_t)(p - p_buf);
+}
+
+/*******************************************************************************
+ * Function Name: runtime_stats_print
+ *******************************************************************************
+ * Summary:
+ *  Print a sample on the debug UART.
+ *
+ * Parameters:
+ *  const runtime_stats_t *p_stats : sample
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void runtime_stats_print(const runtime_stats_t *p_stats)
+{
+    printf("Runtime stats over %ldms:\n", p_stats->window_us / 1000u);
+    printf("  %-8s %4s %7s %10s\n", "task", "prio", "cpu", "stack free");
+    for(uint8_t i = 0u; i < p_stats->num_tasks; i++)
+    {
+        printf("  %-8.8s %4d %3d.%d%% %6d words\n", p_stats->task[i].name, p_stats->task[i].priority,
+               p_stats->task[i].cpu_permille / 10u, p_stats->task[i].cpu_permille % 10u,
+               p_stats->task[i].stack_free_words);
+    }
+    printf("  mesh heap: %ld of %ld bytes used, peak %ld, largest free %ld\n", p_stats->mesh_heap_used,
+           p_stats->mesh_heap_size, p_stats->mesh_heap_peak, p_stats->mesh_heap_largest_free);
+    printf("  FreeRTOS heap (%s): %ld of %ld bytes used\n", rtos_heap_name(), p_stats->rtos_heap_used,
+           p_stats->rtos_heap_size);
+}
+
+#endif /* ENABLE_RUNTIME_STATS */
+
+/* [] END OF FILE */
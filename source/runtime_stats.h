@@ -0,0 +1,101 @@
+/*******************************************************************************
+* File Name: runtime_stats.h
+*
+* Description: This file is the public interface of runtime_stats.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef RUNTIME_STATS_H_
+#define RUNTIME_STATS_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "stdint.h"
+#include "stdbool.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define RUNTIME_STATS_MAX_TASKS         (16u)
+#define RUNTIME_STATS_NAME_LEN          (8u)    /* task name bytes kept, not terminated */
+
+/* The run time counter is the DWT cycle counter extended to 64 bits and
+ * divided by 2^RUNTIME_STATS_SHIFT, 1.5 MHz at 96 MHz */
+#define RUNTIME_STATS_SHIFT             (6u)
+
+/* Length of the binary blob: header, then one record per task */
+#define RUNTIME_STATS_BLOB_HDR_LEN      (30u)
+#define RUNTIME_STATS_BLOB_TASK_LEN     (RUNTIME_STATS_NAME_LEN + 5u)
+#define RUNTIME_STATS_BLOB_MAX_LEN      (RUNTIME_STATS_BLOB_HDR_LEN + \
+                                         (RUNTIME_STATS_MAX_TASKS * RUNTIME_STATS_BLOB_TASK_LEN))
+#define RUNTIME_STATS_BLOB_VERSION      (1u)
+
+/* Usage of one task since the previous sample */
+typedef struct
+{
+    char name[RUNTIME_STATS_NAME_LEN];
+    uint16_t cpu_permille;                      /* share of the sample window */
+    uint16_t stack_free_words;                  /* stack high-water mark, unused words */
+    uint8_t priority;
+} runtime_stats_task_t;
+
+typedef struct
+{
+    uint32_t window_us;                         /* time since the previous sample */
+    uint32_t mesh_heap_size;
+    uint32_t mesh_heap_used;
+    uint32_t mesh_heap_peak;
+    uint32_t mesh_heap_largest_free;
+    uint32_t rtos_heap_size;                    /* bytes managed by the RTOS_HEAP engine */
+    uint32_t rtos_heap_used;
+    uint8_t num_tasks;
+    runtime_stats_task_t task[RUNTIME_STATS_MAX_TASKS];
+} runtime_stats_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void runtime_stats_timer_init(void);
+uint32_t runtime_stats_counter(void);
+void runtime_stats_sample(runtime_stats_t *p_stats);
+uint32_t runtime_stats_serialize(const runtime_stats_t *p_stats, uint8_t *p_buf, uint32_t size);
+void runtime_stats_print(const runtime_stats_t *p_stats);
+
+#endif /* RUNTIME_STATS_H_ */
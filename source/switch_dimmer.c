@@ -54,16 +54,61 @@
 #include "mesh_cfg.h"
 #include "mesh_app.h"
 #include "board.h"
+#include "dimmer_curve.h"
+#include "dimmer_encode.h"
+#include "app_log.h"
+#include "semphr.h"
+#include <stdlib.h>
 
 /*******************************************************************************
  * Macros
  ******************************************************************************/
-#define SWITCH_NUM_LEVELS                (9u)
+#define SWITCH_NUM_LEVELS                (DIMMER_NUM_STEPS)
+
+/* Generic Level Move delta is expressed per this transition time step */
+#define SWITCH_MOVE_STEP_TIME_MS         (100u)
+#define SWITCH_LEVEL_MIN                 (-32768)
+#define SWITCH_LEVEL_MAX                 (32767)
+
+/* Number of destinations tracked by the outbound level command stage, the
+ * fan-out destinations and the client publication */
+#define SWITCH_TX_MAX_DEST               (MESH_FANOUT_MAX_DST + 1u)
+
+/* Level sets of one destination handed to the mesh core at a time */
+#define SWITCH_TX_MAX_IN_FLIGHT          (4u)
+
+/* Resolution and range of the delay field of the level messages */
+#define SWITCH_DELAY_STEP_MS             (5u)
+#define SWITCH_DELAY_MAX_MS              (255u * SWITCH_DELAY_STEP_MS)
+
+/* Client model the level set commands are sent with */
+#if (MESH_CLIENT_MODE == MESH_CLIENT_MODE_LIGHTNESS_ACTUAL) || (MESH_CLIENT_MODE == MESH_CLIENT_MODE_LIGHTNESS_LINEAR)
+#define SWITCH_SET_MODEL_ID              WICED_BT_MESH_CORE_MODEL_ID_LIGHT_LIGHTNESS_CLNT
+#elif (MESH_CLIENT_MODE == MESH_CLIENT_MODE_CTL)
+#define SWITCH_SET_MODEL_ID              WICED_BT_MESH_CORE_MODEL_ID_LIGHT_CTL_CLNT
+#else
+#define SWITCH_SET_MODEL_ID              WICED_BT_MESH_CORE_MODEL_ID_GENERIC_LEVEL_CLNT
+#endif
 /*******************************************************************************
 * Function Prototypes
 *******************************************************************************/
 static void mesh_level_client_message_handler(uint16_t event, wiced_bt_mesh_event_t *p_event,
                                             wiced_bt_mesh_level_status_data_t *p_data);
+#if (MESH_CLIENT_MODE != MESH_CLIENT_MODE_LEVEL)
+static void mesh_light_client_message_handler(uint16_t event, wiced_bt_mesh_event_t *p_event,
+                                              void *p_data);
+#endif
+static void mesh_scene_client_message_handler(uint16_t event, wiced_bt_mesh_event_t *p_event,
+                                              void *p_data);
+static void mesh_dimmer_tx_lock(void);
+static void mesh_dimmer_tx_unlock(void);
+static void mesh_dimmer_tx_submit(uint16_t dst, wiced_bt_mesh_level_set_level_t *p_data, bool is_final);
+static void mesh_dimmer_tx_complete(wiced_bt_mesh_event_t *p_event);
+static void mesh_dimmer_fanout_start(wiced_bt_mesh_level_set_level_t *p_set_data,
+                                     wiced_bt_mesh_level_set_move_t *p_move_data, bool is_final);
+static void mesh_dimmer_fanout_timer_cb(TimerHandle_t timer_handle);
+static void mesh_dimmer_cache_update(uint16_t addr, int16_t level);
+static void mesh_dimmer_fanout_status(uint16_t src, uint32_t remaining_ms);
 void mesh_dimmer_set_level(bool is_instant, bool is_final);
 /*******************************************************************************
  * Variables Definitions
@@ -71,9 +116,10 @@ void mesh_dimmer_set_level(bool is_instant, bool is_final);
 /* Variable to keep the level step */
 extern uint8_t button_step_count;
 
-uint16_t client_level_step[SWITCH_NUM_LEVELS] =
+/* Generic Level of each step, generated at compile time from DIMMER_CURVE */
+const int16_t client_level_step[SWITCH_NUM_LEVELS] =
 {
-    0x8000, 0xa000, 0xC000, 0xE000, 0x0000, 0x2000, 0x4000, 0x6000, 0x7FFF,
+    DIMMER_CURVE_LEVEL_TABLE
 };
 
 /* Structure to keep the light state of lightness server. */
@@ -86,6 +132,147 @@ typedef struct
 /* Application state */
 mesh_level_state_t app_state;
 
+/* Structure to keep the hold-to-dim Generic Level Move in progress. */
+typedef struct
+{
+    bool is_moving;
+    bool is_up;
+    int16_t start_level;
+    TickType_t start_tick;
+} mesh_level_move_t;
+
+static mesh_level_move_t move_state;
+
+/* Number of level client messages sent for the current ramp */
+static uint16_t ramp_msg_count = 0u;
+
+/* Level set handed to the mesh core. The completion is matched by the event,
+ * so the completions of other level client messages are told apart. */
+typedef struct
+{
+    wiced_bt_mesh_event_t *p_event;             /* NULL for a free record */
+    bool is_final;
+    TickType_t send_tick;                       /* time the command was sent */
+} mesh_level_tx_send_t;
+
+/* Outbound level command stage for one destination. While a command is in
+ * flight only the newest pending level is kept, older ones are superseded. */
+typedef struct
+{
+    bool in_use;
+    uint16_t dst;                               /* 0 uses the client publication */
+    uint16_t resolved_dst;                      /* destination reported by the core */
+    uint8_t in_flight;                          /* commands handed to the mesh core */
+    mesh_level_tx_send_t sent[SWITCH_TX_MAX_IN_FLIGHT];
+    bool is_pending;
+    bool pending_final;
+    wiced_bt_mesh_level_set_level_t pending_data;
+    TickType_t final_tick;                      /* time the final level was requested */
+    uint16_t superseded_count;
+    uint16_t final_count;                       /* final commands sent */
+    uint8_t ack_samples;                        /* acknowledged sends completed, saturates */
+    uint8_t success_pct;                        /* moving average of acknowledged delivery */
+    uint32_t latency_ms;                        /* moving average of acknowledged latency */
+    uint32_t pdu_count;                         /* access PDUs sent including retransmissions */
+} mesh_level_tx_t;
+
+static mesh_level_tx_t level_tx[SWITCH_TX_MAX_DEST];
+
+/* Serializes the outbound stage and the fan-out between the board task, the
+ * timer daemon and the Bluetooth stack task. Recursive as a completion can be
+ * reported from within a send. */
+static SemaphoreHandle_t level_tx_mutex = NULL;
+
+/* Level command fanned out to several destinations. The command is built once
+ * and the same data is sent to every destination, paced by the fan-out timer. */
+typedef struct
+{
+    uint16_t dst[MESH_FANOUT_MAX_DST];
+    uint8_t num_dst;
+    uint8_t next;                               /* next destination to send to */
+    uint16_t delay_ms[MESH_FANOUT_MAX_DST];     /* delay aligning the transition starts */
+    bool is_move;
+    bool is_final;
+    wiced_bt_mesh_level_set_level_t set_data;
+    wiced_bt_mesh_level_set_move_t move_data;
+    uint16_t status_mask;                       /* destinations that reported the final level */
+    TickType_t end_tick[MESH_FANOUT_MAX_DST];   /* reported end of the transition */
+} mesh_level_fanout_t;
+
+static mesh_level_fanout_t fanout = { .dst = { MESH_FANOUT_DST_LIST 0 } };
+
+static TimerHandle_t fanout_timer = NULL;
+
+/* Last known level of a server, updated from the level status messages */
+typedef struct
+{
+    uint16_t addr;                              /* 0 for an unused entry */
+    int16_t level;
+    uint32_t last_used;                         /* LRU stamp */
+    TickType_t update_tick;
+} mesh_level_cache_t;
+
+static mesh_level_cache_t level_cache[MESH_LEVEL_CACHE_SIZE];
+static uint32_t level_cache_stamp = 0u;
+
+/* Time the last level command was requested by the button */
+static TickType_t last_command_tick = 0u;
+
+/* Observed cadence of the hold-to-dim steps */
+typedef struct
+{
+    TickType_t last_step_tick;                  /* 0 outside of a ramp */
+    uint32_t cadence_ms;                        /* moving average of the step interval */
+    uint32_t jitter_ms;                         /* moving average of the interval deviation */
+    uint32_t max_jitter_ms;                     /* largest deviation of the current ramp */
+    uint32_t transition_ms;                     /* transition time of the last step */
+} mesh_level_step_timing_t;
+
+static mesh_level_step_timing_t step_timing = { .cadence_ms = MESH_STEP_INTERVAL_MS };
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_tx_lock
+ *******************************************************************************
+ * Summary:
+ *  Take the lock of the outbound stage. Before the level client is
+ *  initialized only the board task uses the stage, and no lock is taken.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_dimmer_tx_lock(void)
+{
+    if(NULL != level_tx_mutex)
+    {
+        xSemaphoreTakeRecursive(level_tx_mutex, portMAX_DELAY);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_tx_unlock
+ *******************************************************************************
+ * Summary:
+ *  Release the lock of the outbound stage.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_dimmer_tx_unlock(void)
+{
+    if(NULL != level_tx_mutex)
+    {
+        xSemaphoreGiveRecursive(level_tx_mutex);
+    }
+}
+
 /*******************************************************************************
  * Function Name: mesh_level_client_model_init
  *******************************************************************************
@@ -103,6 +290,83 @@ void mesh_level_client_model_init(wiced_bool_t is_provisioned)
 {
     wiced_bt_mesh_model_level_client_init(MESH_LEVEL_CLIENT_ELEMENT_INDEX,
             mesh_level_client_message_handler, is_provisioned);
+#if (MESH_CLIENT_MODE == MESH_CLIENT_MODE_LIGHTNESS_ACTUAL) || (MESH_CLIENT_MODE == MESH_CLIENT_MODE_LIGHTNESS_LINEAR)
+    wiced_bt_mesh_model_light_lightness_client_init(MESH_LEVEL_CLIENT_ELEMENT_INDEX,
+            mesh_light_client_message_handler, is_provisioned);
+#elif (MESH_CLIENT_MODE == MESH_CLIENT_MODE_CTL)
+    wiced_bt_mesh_model_light_ctl_client_init(MESH_LEVEL_CLIENT_ELEMENT_INDEX,
+            mesh_light_client_message_handler, is_provisioned);
+#endif
+    wiced_bt_mesh_model_scene_client_init(MESH_LEVEL_CLIENT_ELEMENT_INDEX,
+            mesh_scene_client_message_handler, is_provisioned);
+
+    if(NULL == level_tx_mutex)
+    {
+        level_tx_mutex = xSemaphoreCreateRecursiveMutex();
+        if(NULL == level_tx_mutex)
+        {
+            printf("Level tx mutex initialization failed!\r\n");
+            CY_ASSERT(0u);
+        }
+    }
+
+    if(NULL == fanout_timer)
+    {
+        /* The configured destination list ends at the first unassigned address */
+        for(fanout.num_dst = 0; fanout.num_dst < MESH_FANOUT_MAX_DST; fanout.num_dst++)
+        {
+            if(0u == fanout.dst[fanout.num_dst])
+            {
+                break;
+            }
+        }
+
+        fanout_timer = xTimerCreate("fanout_timer", pdMS_TO_TICKS(MESH_FANOUT_PACING_MS),
+                                    pdFALSE, NULL, mesh_dimmer_fanout_timer_cb);
+        if(NULL == fanout_timer)
+        {
+            printf("Fan-out timer initialization failed!\r\n");
+            CY_ASSERT(0u);
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_fanout_set
+ *******************************************************************************
+ * Summary:
+ *  Set the group or unicast destinations the level commands are fanned out
+ *  to. With no destinations, the level client publication is used.
+ *
+ * Parameters:
+ *  const uint16_t *p_dst : destination addresses
+ *  uint8_t num_dst : number of destinations, up to MESH_FANOUT_MAX_DST
+ *
+ * Return:
+ *  wiced_bool_t : WICED_TRUE if the destinations are set
+ *
+ ******************************************************************************/
+wiced_bool_t mesh_dimmer_fanout_set(const uint16_t *p_dst, uint8_t num_dst)
+{
+    if((num_dst > MESH_FANOUT_MAX_DST) || ((0u != num_dst) && (NULL == p_dst)))
+    {
+        return WICED_FALSE;
+    }
+
+    mesh_dimmer_tx_lock();
+    if(NULL != fanout_timer)
+    {
+        xTimerStop(fanout_timer, 0u);
+    }
+    if(0u != num_dst)
+    {
+        memcpy(fanout.dst, p_dst, num_dst * sizeof(uint16_t));
+    }
+    fanout.num_dst = num_dst;
+    fanout.next = num_dst;
+    mesh_dimmer_tx_unlock();
+
+    return WICED_TRUE;
 }
 
 /*******************************************************************************
@@ -127,9 +391,14 @@ void mesh_level_client_message_handler(uint16_t event, wiced_bt_mesh_event_t *p_
     switch (event)
     {
     case WICED_BT_MESH_TX_COMPLETE:
-        printf("Mesh client level tx complete status:%d\n", p_event->status.tx_flag);
+        APP_LOG1(LEVEL_TX_COMPLETE, p_event->status.tx_flag);
+        mesh_dimmer_tx_complete(p_event);
         break;
     case WICED_BT_MESH_LEVEL_STATUS:
+        APP_LOG3(LEVEL_STATUS, p_event->src, p_data->present_level, p_data->target_level);
+        mesh_dimmer_cache_update(p_event->src,
+                (0u != p_data->remaining_time) ? p_data->target_level : p_data->present_level);
+        mesh_dimmer_fanout_status(p_event->src, p_data->remaining_time);
         break;
 
     default:
@@ -139,6 +408,256 @@ void mesh_level_client_message_handler(uint16_t event, wiced_bt_mesh_event_t *p_
 
 }
 
+#if (MESH_CLIENT_MODE != MESH_CLIENT_MODE_LEVEL)
+/*******************************************************************************
+ * Function Name: mesh_light_client_message_handler
+ *******************************************************************************
+ * Summary:
+ *  Light Lightness or Light CTL client message handler. The lightness in the
+ *  status is converted back to the bound Generic Level for the level cache.
+ *
+ * Parameters:
+ *  uint16_t event : event type
+ *  wiced_bt_mesh_event_t *p_even : event pointer
+ *  void *p_data : event data
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_light_client_message_handler(uint16_t event, wiced_bt_mesh_event_t *p_event,
+                                              void *p_data)
+{
+    uint16_t lightness_actual;
+
+    switch (event)
+    {
+    case WICED_BT_MESH_TX_COMPLETE:
+        APP_LOG1(LIGHT_TX_COMPLETE, p_event->status.tx_flag);
+        mesh_dimmer_tx_complete(p_event);
+        break;
+#if (MESH_CLIENT_MODE == MESH_CLIENT_MODE_CTL)
+    case WICED_BT_MESH_LIGHT_CTL_STATUS:
+    {
+        wiced_bt_mesh_light_ctl_status_data_t *p_status = (wiced_bt_mesh_light_ctl_status_data_t *)p_data;
+
+        APP_LOG3(CTL_STATUS, p_event->src, p_status->present.lightness, p_status->present.temperature);
+        lightness_actual = (0u != p_status->remaining_time) ? p_status->target.lightness :
+                                                              p_status->present.lightness;
+        mesh_dimmer_cache_update(p_event->src, dimmer_decode_lightness_actual(lightness_actual));
+        mesh_dimmer_fanout_status(p_event->src, p_status->remaining_time);
+        break;
+    }
+#else
+    case WICED_BT_MESH_LIGHT_LIGHTNESS_STATUS:
+    case WICED_BT_MESH_LIGHT_LIGHTNESS_LINEAR_STATUS:
+    {
+        wiced_bt_mesh_light_lightness_status_data_t *p_status = (wiced_bt_mesh_light_lightness_status_data_t *)p_data;
+
+        APP_LOG3(LIGHTNESS_STATUS, p_event->src, p_status->present, p_status->target);
+        lightness_actual = (0u != p_status->remaining_time) ? p_status->target : p_status->present;
+        if(WICED_BT_MESH_LIGHT_LIGHTNESS_LINEAR_STATUS == event)
+        {
+            lightness_actual = dimmer_decode_lightness_linear(lightness_actual);
+        }
+        mesh_dimmer_cache_update(p_event->src, dimmer_decode_lightness_actual(lightness_actual));
+        mesh_dimmer_fanout_status(p_event->src, p_status->remaining_time);
+        break;
+    }
+#endif
+
+    default:
+        printf("Mesh light client unknown event:%d\r\n", event);
+        break;
+    }
+}
+#endif
+
+/*******************************************************************************
+ * Function Name: mesh_scene_client_message_handler
+ *******************************************************************************
+ * Summary:
+ *  Scene client message handler.
+ *
+ * Parameters:
+ *  uint16_t event : event type
+ *  wiced_bt_mesh_event_t *p_even : event pointer
+ *  void *p_data : event data
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_scene_client_message_handler(uint16_t event, wiced_bt_mesh_event_t *p_event,
+                                              void *p_data)
+{
+    wiced_bt_mesh_scene_status_data_t *p_status = (wiced_bt_mesh_scene_status_data_t *)p_data;
+
+    switch (event)
+    {
+    case WICED_BT_MESH_TX_COMPLETE:
+        APP_LOG1(SCENE_TX_COMPLETE, p_event->status.tx_flag);
+        break;
+    case WICED_BT_MESH_SCENE_STATUS:
+        APP_LOG4(SCENE_STATUS, p_event->src, p_status->status_code, p_status->current_scene,
+                 p_status->target_scene);
+        break;
+
+    default:
+        printf("Mesh scene client unknown event:%d\r\n", event);
+        break;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_latency_ms
+ *******************************************************************************
+ * Summary:
+ *  Time for a level command to reach the last destination: the fan-out pacing
+ *  plus the largest acknowledged delivery latency measured so far.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  uint32_t : delivery latency in milliseconds
+ *
+ ******************************************************************************/
+static uint32_t mesh_dimmer_latency_ms(void)
+{
+    uint32_t latency_ms = 0u;
+
+    for(uint8_t i = 0u; i < SWITCH_TX_MAX_DEST; i++)
+    {
+        if(level_tx[i].in_use && (level_tx[i].latency_ms > latency_ms))
+        {
+            latency_ms = level_tx[i].latency_ms;
+        }
+    }
+    if(fanout.num_dst > 1u)
+    {
+        latency_ms += (uint32_t)(fanout.num_dst - 1u) * MESH_FANOUT_PACING_MS;
+    }
+    return latency_ms;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_repeat_interval_ms
+ *******************************************************************************
+ * Summary:
+ *  Interval between the hold-to-dim steps. Steps are not repeated faster than
+ *  they are delivered, as the outbound stage would only drop the superseded
+ *  ones, so the interval grows with the delivery latency.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  uint32_t : step interval in milliseconds
+ *
+ ******************************************************************************/
+uint32_t mesh_dimmer_repeat_interval_ms(void)
+{
+    uint32_t interval_ms = mesh_dimmer_latency_ms() + MESH_STEP_LATENCY_MARGIN_MS;
+
+    if(interval_ms < MESH_STEP_INTERVAL_MS)
+    {
+        interval_ms = MESH_STEP_INTERVAL_MS;
+    }
+    else if(interval_ms > MESH_STEP_INTERVAL_MAX_MS)
+    {
+        interval_ms = MESH_STEP_INTERVAL_MAX_MS;
+    }
+    return interval_ms;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_step_transition
+ *******************************************************************************
+ * Summary:
+ *  Update the observed step cadence and get the transition time of a
+ *  hold-to-dim step. The transition lasts until the next step is expected,
+ *  plus the observed jitter, so the light does not stop between steps.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  uint32_t : transition time in milliseconds
+ *
+ ******************************************************************************/
+static uint32_t mesh_dimmer_step_transition(void)
+{
+    TickType_t now = xTaskGetTickCount();
+    uint32_t interval_ms;
+    uint32_t deviation_ms;
+
+    interval_ms = (uint32_t)(now - step_timing.last_step_tick) * portTICK_PERIOD_MS;
+
+    if((0u == step_timing.last_step_tick) || (interval_ms > MESH_STEP_GAP_MAX_MS))
+    {
+        /* First step of a ramp, or an idle gap that is not a step interval,
+         * start from the planned interval */
+        step_timing.cadence_ms = mesh_dimmer_repeat_interval_ms();
+        step_timing.max_jitter_ms = 0u;
+    }
+    else
+    {
+        deviation_ms = (interval_ms > step_timing.cadence_ms) ? (interval_ms - step_timing.cadence_ms) :
+                                                                (step_timing.cadence_ms - interval_ms);
+        step_timing.cadence_ms = (step_timing.cadence_ms * 7u + interval_ms) / 8u;
+        step_timing.jitter_ms = (step_timing.jitter_ms * 7u + deviation_ms) / 8u;
+        if(deviation_ms > step_timing.max_jitter_ms)
+        {
+            step_timing.max_jitter_ms = deviation_ms;
+        }
+    }
+    step_timing.last_step_tick = now;
+    step_timing.transition_ms = step_timing.cadence_ms + step_timing.jitter_ms;
+
+    return step_timing.transition_ms;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_step_remaining
+ *******************************************************************************
+ * Summary:
+ *  Get the time left of the running hold-to-dim step. The final level sent on
+ *  release repeats the last step, and completes its transition at the time the
+ *  step would have.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  uint32_t : transition time in milliseconds
+ *
+ ******************************************************************************/
+static uint32_t mesh_dimmer_step_remaining(void)
+{
+    uint32_t elapsed_ms = (uint32_t)(xTaskGetTickCount() - step_timing.last_step_tick) * portTICK_PERIOD_MS;
+
+    return (elapsed_ms < step_timing.transition_ms) ? (step_timing.transition_ms - elapsed_ms) : 0u;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_num_dst
+ *******************************************************************************
+ * Summary:
+ *  Number of destinations a level command is sent to.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  uint32_t : fan-out destinations, 1 for the client publication
+ *
+ ******************************************************************************/
+static uint32_t mesh_dimmer_num_dst(void)
+{
+    return (0u != fanout.num_dst) ? fanout.num_dst : 1u;
+}
+
 /*******************************************************************************
  * Function Name: mesh_dimmer_set_level
  *******************************************************************************
@@ -158,16 +677,1079 @@ void mesh_dimmer_set_level(bool is_instant, bool is_final)
 
     wiced_bt_mesh_level_set_level_t set_data;
 
+    last_command_tick = xTaskGetTickCount();
     set_data.level = client_level_step[button_step_count];
-    set_data.transition_time = is_instant ? 100 : 500;
+    if(is_instant)
+    {
+        set_data.transition_time = MESH_TRANSITION_INTERVAL;
+    }
+    else if(is_final && (0u != step_timing.last_step_tick) && (set_data.level == app_state.level_step))
+    {
+        /* Released mid-ramp, the final level repeats the running step */
+        set_data.transition_time = mesh_dimmer_step_remaining();
+    }
+    else
+    {
+        set_data.transition_time = mesh_dimmer_step_transition();
+    }
     set_data.delay = 0;
 
     app_state.level_step = set_data.level;
     app_state.remaining_time = set_data.transition_time;
 
-    printf("Mesh client set level:%d transition time:%ld final:%d\n", set_data.level, set_data.transition_time, is_final);
-    wiced_bt_mesh_model_level_client_set(0, is_final, &set_data);
+    APP_LOG3(SET_LEVEL, set_data.level, set_data.transition_time, is_final);
+    mesh_dimmer_fanout_start(&set_data, NULL, is_final);
+
+    if(is_instant)
+    {
+        /* An instant command ends any ramp */
+        ramp_msg_count = 0u;
+        step_timing.last_step_tick = 0u;
+    }
+    else if(is_final)
+    {
+        /* A move would take a move and a final level per destination */
+        APP_LOG2(RAMP_DONE, ramp_msg_count, 2u * mesh_dimmer_num_dst());
+        APP_LOG3(STEP_CADENCE, step_timing.cadence_ms, step_timing.jitter_ms, step_timing.max_jitter_ms);
+        ramp_msg_count = 0u;
+        step_timing.last_step_tick = 0u;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_send_level
+ *******************************************************************************
+ * Summary:
+ *  Send a level chosen by the host MCU to one destination, or to all fan-out
+ *  destinations. The command goes through the same outbound stage as the
+ *  button commands, so a newer level supersedes a pending one.
+ *
+ * Parameters:
+ *  uint16_t dst : destination address, 0 for the fan-out destinations
+ *  wiced_bt_mesh_level_set_level_t *p_data : level to send
+ *  bool is_final : final flag
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void mesh_dimmer_send_level(uint16_t dst, wiced_bt_mesh_level_set_level_t *p_data, bool is_final)
+{
+    last_command_tick = xTaskGetTickCount();
+
+    if(0u == dst)
+    {
+        mesh_dimmer_fanout_start(p_data, NULL, is_final);
+    }
+    else
+    {
+        mesh_dimmer_tx_submit(dst, p_data, is_final);
+    }
 }
 
+/*******************************************************************************
+ * Function Name: mesh_dimmer_nearest_step
+ *******************************************************************************
+ * Summary:
+ *  Find the level step closest to a Generic Level value.
+ *
+ * Parameters:
+ *  int32_t level : Generic Level value
+ *
+ * Return:
+ *  uint8_t : level step
+ *
+ ******************************************************************************/
+static uint8_t mesh_dimmer_nearest_step(int32_t level)
+{
+    uint32_t distance;
+    uint32_t min_distance = UINT32_MAX;
+    uint8_t nearest = 0u;
+    uint8_t step;
+
+    for(step = 0; step < SWITCH_NUM_LEVELS; step++)
+    {
+        distance = (uint32_t)abs(level - client_level_step[step]);
+        if(distance < min_distance)
+        {
+            min_distance = distance;
+            nearest = step;
+        }
+    }
+    return nearest;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_cache_update
+ *******************************************************************************
+ * Summary:
+ *  Store the last known level of a server. When the cache is full, the least
+ *  recently used entry is replaced.
+ *
+ * Parameters:
+ *  uint16_t addr : server address
+ *  int16_t level : level reported by the server
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_dimmer_cache_update(uint16_t addr, int16_t level)
+{
+    mesh_level_cache_t *p_entry = &level_cache[0];
+    uint8_t i;
+
+    /* Called from the stack, the board task reads the cache */
+    mesh_dimmer_tx_lock();
+    for(i = 0; i < MESH_LEVEL_CACHE_SIZE; i++)
+    {
+        if(level_cache[i].addr == addr)
+        {
+            p_entry = &level_cache[i];
+            break;
+        }
+        if(level_cache[i].last_used < p_entry->last_used)
+        {
+            p_entry = &level_cache[i];
+        }
+    }
+
+    p_entry->addr = addr;
+    p_entry->level = level;
+    p_entry->last_used = ++level_cache_stamp;
+    p_entry->update_tick = xTaskGetTickCount();
+    mesh_dimmer_tx_unlock();
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_cache_find
+ *******************************************************************************
+ * Summary:
+ *  Find the cache entry of a server.
+ *
+ * Parameters:
+ *  uint16_t addr : server address
+ *
+ * Return:
+ *  mesh_level_cache_t * : entry of the server, NULL if it is not cached
+ *
+ ******************************************************************************/
+static mesh_level_cache_t *mesh_dimmer_cache_find(uint16_t addr)
+{
+    for(uint8_t i = 0u; i < MESH_LEVEL_CACHE_SIZE; i++)
+    {
+        if((0u != addr) && (level_cache[i].addr == addr))
+        {
+            return &level_cache[i];
+        }
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_cache_get
+ *******************************************************************************
+ * Summary:
+ *  Get the last known level of a server.
+ *
+ * Parameters:
+ *  uint16_t addr : server address
+ *  int16_t *p_level : level of the server
+ *
+ * Return:
+ *  wiced_bool_t : WICED_TRUE if the server is in the cache
+ *
+ ******************************************************************************/
+wiced_bool_t mesh_dimmer_cache_get(uint16_t addr, int16_t *p_level)
+{
+    mesh_level_cache_t *p_entry;
+
+    mesh_dimmer_tx_lock();
+    p_entry = mesh_dimmer_cache_find(addr);
+    if(NULL == p_entry)
+    {
+        mesh_dimmer_tx_unlock();
+        return WICED_FALSE;
+    }
+    p_entry->last_used = ++level_cache_stamp;
+    *p_level = p_entry->level;
+    mesh_dimmer_tx_unlock();
+    return WICED_TRUE;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_sync_step
+ *******************************************************************************
+ * Summary:
+ *  Align the button step with the level last reported by a destination of
+ *  this switch, if the report is newer than the last command of this switch.
+ *  This keeps the next press from jumping when another controller has
+ *  changed the light. The destinations are the fan-out destinations, or the
+ *  publication address the last command went to. Servers reached only
+ *  through a group address are not cached under it, so no sync is done then.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  bool : true if the button step has changed
+ *
+ ******************************************************************************/
+bool mesh_dimmer_sync_step(void)
+{
+    mesh_level_cache_t *p_entry = NULL;
+    mesh_level_cache_t *p_found;
+    mesh_level_cache_t entry;
+    uint8_t step;
+    uint8_t i;
+
+    mesh_dimmer_tx_lock();
+    if(0u != fanout.num_dst)
+    {
+        /* The destination reported last, of the fan-out destinations */
+        for(i = 0u; i < fanout.num_dst; i++)
+        {
+            p_found = mesh_dimmer_cache_find(fanout.dst[i]);
+            if((NULL != p_found) &&
+               ((NULL == p_entry) || ((int32_t)(p_found->update_tick - p_entry->update_tick) > 0)))
+            {
+                p_entry = p_found;
+            }
+        }
+    }
+    else
+    {
+        for(i = 0u; i < SWITCH_TX_MAX_DEST; i++)
+        {
+            if(level_tx[i].in_use && (0u == level_tx[i].dst))
+            {
+                p_entry = mesh_dimmer_cache_find(level_tx[i].resolved_dst);
+                break;
+            }
+        }
+    }
+    if(NULL == p_entry)
+    {
+        mesh_dimmer_tx_unlock();
+        return false;
+    }
+    /* The entry is copied, the stack can replace it once unlocked */
+    p_entry->last_used = ++level_cache_stamp;
+    entry = *p_entry;
+    mesh_dimmer_tx_unlock();
+
+    if((int32_t)(entry.update_tick - last_command_tick) <= 0)
+    {
+        return false;
+    }
+
+    step = mesh_dimmer_nearest_step(entry.level);
+    if(step == button_step_count)
+    {
+        return false;
+    }
+
+    APP_LOG2(STEP_SYNCED, step, entry.addr);
+    button_step_count = step;
+    return true;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_scene_recall
+ *******************************************************************************
+ * Summary:
+ *  Recall a scene with a single unacknowledged Scene Recall to the scene
+ *  client publication. All the lights subscribed to it move to their stored
+ *  state, instead of receiving a level set each.
+ *
+ * Parameters:
+ *  uint16_t scene_number : scene to recall, 1 to 65535
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void mesh_dimmer_scene_recall(uint16_t scene_number)
+{
+    wiced_bt_mesh_event_t *p_event;
+    wiced_bt_mesh_scene_recall_t recall_data;
+
+    if(0u == scene_number)
+    {
+        return;
+    }
+
+    p_event = wiced_bt_mesh_create_event(MESH_LEVEL_CLIENT_ELEMENT_INDEX, MESH_COMPANY_ID_BT_SIG,
+                                         WICED_BT_MESH_CORE_MODEL_ID_SCENE_CLNT, 0, 0);
+    if(NULL == p_event)
+    {
+        printf("Mesh client scene recall failed: no publication\r\n");
+        return;
+    }
+    p_event->reply = WICED_FALSE;
+    p_event->retrans_cnt = MESH_TX_UNACK_RETRANS_CNT;
+
+    recall_data.scene_number = scene_number;
+    recall_data.transition_time = MESH_TRANSITION_INTERVAL;
+    recall_data.delay = 0;
+
+    /* The levels cached so far no longer describe the lights */
+    last_command_tick = xTaskGetTickCount();
+
+    APP_LOG1(SCENE_RECALL, scene_number);
+    wiced_bt_mesh_model_scene_client_send_recall(p_event, &recall_data);
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_move_start
+ *******************************************************************************
+ * Summary:
+ *  Start hold-to-dim by sending a single Generic Level Move. The server keeps
+ *  changing the level at MESH_LEVEL_MOVE_RATE until the move is stopped.
+ *
+ * Parameters:
+ *  bool is_up : move towards the maximum level if true
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void mesh_dimmer_move_start(bool is_up)
+{
+    wiced_bt_mesh_level_set_move_t move_data;
+    int32_t delta = (int32_t)((MESH_LEVEL_MOVE_RATE * SWITCH_MOVE_STEP_TIME_MS) / 1000u);
+
+    move_data.delta = (int16_t)(is_up ? delta : -delta);
+    move_data.transition_time = SWITCH_MOVE_STEP_TIME_MS;
+    move_data.delay = 0;
+
+    move_state.is_moving = true;
+    move_state.is_up = is_up;
+    move_state.start_level = client_level_step[button_step_count];
+    move_state.start_tick = xTaskGetTickCount();
+    last_command_tick = move_state.start_tick;
+    ramp_msg_count = 0u;
+
+    APP_LOG2(MOVE_START, move_data.delta, SWITCH_MOVE_STEP_TIME_MS);
+    mesh_dimmer_fanout_start(NULL, &move_data, false);
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_move_stop
+ *******************************************************************************
+ * Summary:
+ *  Stop hold-to-dim. The level reached by the server is estimated from the
+ *  hold duration and sent as the final level set, so that the light stops at
+ *  a known level. The button step is updated to the nearest level step.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void mesh_dimmer_move_stop(void)
+{
+    wiced_bt_mesh_level_set_level_t set_data;
+    uint32_t elapsed_ms;
+    uint32_t step_msgs;
+    int32_t level;
+    int32_t delta;
+    uint8_t start_step;
+
+    if(!move_state.is_moving)
+    {
+        return;
+    }
+    move_state.is_moving = false;
+
+    last_command_tick = xTaskGetTickCount();
+    elapsed_ms = (uint32_t)(last_command_tick - move_state.start_tick) * portTICK_PERIOD_MS;
+    delta = (int32_t)(((uint64_t)MESH_LEVEL_MOVE_RATE * elapsed_ms) / 1000u);
+    level = move_state.is_up ? (move_state.start_level + delta) : (move_state.start_level - delta);
+
+    if(level > SWITCH_LEVEL_MAX)
+    {
+        level = SWITCH_LEVEL_MAX;
+    }
+    else if(level < SWITCH_LEVEL_MIN)
+    {
+        level = SWITCH_LEVEL_MIN;
+    }
+
+    /* Keep the button step in sync with the level the move stopped at */
+    start_step = mesh_dimmer_nearest_step(move_state.start_level);
+    button_step_count = mesh_dimmer_nearest_step(level);
+
+    /* Step mode sends every step to every destination, and repeats the last
+     * one as final when released before an end step */
+    step_msgs = (button_step_count > start_step) ? (button_step_count - start_step) : (start_step - button_step_count);
+    if((0u == step_msgs) || ((0u != button_step_count) && ((SWITCH_NUM_LEVELS - 1u) != button_step_count)))
+    {
+        step_msgs++;
+    }
+    step_msgs *= mesh_dimmer_num_dst();
+
+    set_data.level = (int16_t)level;
+    set_data.transition_time = SWITCH_MOVE_STEP_TIME_MS;
+    set_data.delay = 0;
+
+    app_state.level_step = set_data.level;
+    app_state.remaining_time = set_data.transition_time;
+
+    mesh_dimmer_fanout_start(&set_data, NULL, true);
+
+    APP_LOG3(MOVE_STOP, level, ramp_msg_count, step_msgs);
+    ramp_msg_count = 0u;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_tx_policy
+ *******************************************************************************
+ * Summary:
+ *  Select acknowledged or unacknowledged delivery and the retransmission count
+ *  of a level command. With the adaptive policy, intermediate levels are never
+ *  acknowledged and final levels are acknowledged until the destination is
+ *  known to be reliable. Reliable destinations get fewer retransmissions and
+ *  only every MESH_TX_PROBE_INTERVAL final level is acknowledged, to keep the
+ *  delivery statistics up to date.
+ *
+ * Parameters:
+ *  mesh_level_tx_t *p_tx : outbound stage of the destination
+ *  wiced_bt_mesh_event_t *p_event : event of the command to send
+ *  bool is_final : final flag
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_dimmer_tx_policy(mesh_level_tx_t *p_tx, wiced_bt_mesh_event_t *p_event, bool is_final)
+{
+#if (MESH_TX_POLICY == MESH_TX_POLICY_ACK)
+    (void)p_tx;
+    (void)is_final;
+    p_event->reply = WICED_TRUE;
+    p_event->retrans_cnt = MESH_TX_ACK_RETRANS_CNT;
+#elif (MESH_TX_POLICY == MESH_TX_POLICY_UNACK)
+    (void)p_tx;
+    (void)is_final;
+    p_event->reply = WICED_FALSE;
+    p_event->retrans_cnt = MESH_TX_UNACK_RETRANS_CNT;
+#else
+    bool is_reliable = (p_tx->ack_samples >= MESH_TX_MIN_SAMPLES) &&
+                       (p_tx->success_pct >= MESH_TX_RELIABLE_PCT);
+
+    if(is_final && (!is_reliable || (0u == (p_tx->final_count % MESH_TX_PROBE_INTERVAL))))
+    {
+        p_event->reply = WICED_TRUE;
+        p_event->retrans_cnt = MESH_TX_ACK_RETRANS_CNT;
+    }
+    else
+    {
+        /* An unacknowledged final level is not repeated by a later step */
+        p_event->reply = WICED_FALSE;
+        p_event->retrans_cnt = (is_reliable && !is_final) ? 0u : MESH_TX_UNACK_RETRANS_CNT;
+    }
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_send_set
+ *******************************************************************************
+ * Summary:
+ *  Send a level set command with the configured client model. The level is
+ *  encoded to the Light Lightness or Light CTL state the server holds, so the
+ *  server does not have to derive it through the bound Generic Level.
+ *
+ * Parameters:
+ *  wiced_bt_mesh_event_t *p_event : mesh event of the command
+ *  wiced_bt_mesh_level_set_level_t *p_data : level to send
+ *
+ * Return:
+ *  wiced_result_t : result of the client send function
+ *
+ ******************************************************************************/
+static wiced_result_t mesh_dimmer_send_set(wiced_bt_mesh_event_t *p_event, wiced_bt_mesh_level_set_level_t *p_data)
+{
+#if (MESH_CLIENT_MODE == MESH_CLIENT_MODE_LIGHTNESS_ACTUAL)
+    wiced_bt_mesh_light_lightness_actual_set_t set_data;
+
+    set_data.lightness_actual = dimmer_encode_lightness_actual(p_data->level);
+    set_data.transition_time = p_data->transition_time;
+    set_data.delay = (uint16_t)p_data->delay;
+    return wiced_bt_mesh_model_light_lightness_client_send_set(p_event, &set_data);
+#elif (MESH_CLIENT_MODE == MESH_CLIENT_MODE_LIGHTNESS_LINEAR)
+    wiced_bt_mesh_light_lightness_linear_set_t set_data;
+
+    set_data.lightness_linear = dimmer_encode_lightness_linear(dimmer_encode_lightness_actual(p_data->level));
+    set_data.transition_time = p_data->transition_time;
+    set_data.delay = (uint16_t)p_data->delay;
+    return wiced_bt_mesh_model_light_lightness_client_send_linear_set(p_event, &set_data);
+#elif (MESH_CLIENT_MODE == MESH_CLIENT_MODE_CTL)
+    /* Lightness and temperature travel in one message for warm dimming */
+    wiced_bt_mesh_light_ctl_set_t set_data;
+
+    set_data.target.lightness = dimmer_encode_lightness_actual(p_data->level);
+    set_data.target.temperature = dimmer_encode_ctl_temperature(set_data.target.lightness,
+            MESH_CTL_TEMPERATURE_MIN, MESH_CTL_TEMPERATURE_MAX);
+    set_data.target.delta_uv = MESH_CTL_DELTA_UV;
+    set_data.transition_time = p_data->transition_time;
+    set_data.delay = (uint16_t)p_data->delay;
+    return wiced_bt_mesh_model_light_ctl_client_send_set(p_event, &set_data);
+#else
+    return wiced_bt_mesh_model_level_client_send_set(p_event, p_data);
+#endif
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_tx_send
+ *******************************************************************************
+ * Summary:
+ *  Hand a level set command for the destination over to the mesh core.
+ *
+ * Parameters:
+ *  mesh_level_tx_t *p_tx : outbound stage of the destination
+ *  wiced_bt_mesh_level_set_level_t *p_data : level to send
+ *  bool is_final : final flag
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_dimmer_tx_send(mesh_level_tx_t *p_tx, wiced_bt_mesh_level_set_level_t *p_data, bool is_final)
+{
+    wiced_bt_mesh_event_t *p_event;
+    mesh_level_tx_send_t *p_send = NULL;
+    uint32_t pdu_count;
+    wiced_result_t result;
+
+    for(uint8_t i = 0u; i < SWITCH_TX_MAX_IN_FLIGHT; i++)
+    {
+        if(NULL == p_tx->sent[i].p_event)
+        {
+            p_send = &p_tx->sent[i];
+            break;
+        }
+    }
+    if(NULL == p_send)
+    {
+        return;
+    }
+
+    p_event = wiced_bt_mesh_create_event(MESH_LEVEL_CLIENT_ELEMENT_INDEX, MESH_COMPANY_ID_BT_SIG,
+                                         SWITCH_SET_MODEL_ID, p_tx->dst, 0);
+    if(NULL == p_event)
+    {
+        printf("Mesh client set level failed: no destination\r\n");
+        return;
+    }
+
+    p_tx->resolved_dst = p_event->dst;
+    mesh_dimmer_tx_policy(p_tx, p_event, is_final);
+
+    /* Marked in flight before the send, the completion can be reported early */
+    p_tx->in_flight++;
+    p_send->p_event = p_event;
+    p_send->is_final = is_final;
+    p_send->send_tick = xTaskGetTickCount();
+    pdu_count = (uint32_t)p_event->retrans_cnt + 1u;
+    p_tx->pdu_count += pdu_count;
+    if(is_final)
+    {
+        p_tx->final_count++;
+    }
+
+    result = mesh_dimmer_send_set(p_event, p_data);
+    if(WICED_BT_SUCCESS == result)
+    {
+        ramp_msg_count++;
+    }
+    else if(p_send->p_event == p_event)
+    {
+        p_tx->in_flight--;
+        p_send->p_event = NULL;
+        p_tx->pdu_count -= pdu_count;
+        if(is_final)
+        {
+            p_tx->final_count--;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_tx_expire
+ *******************************************************************************
+ * Summary:
+ *  Release the in-flight records of a destination that were not completed
+ *  within MESH_TX_COMPLETE_TIMEOUT_MS, so a lost completion does not block
+ *  the destination. A late completion of a released record is ignored.
+ *
+ * Parameters:
+ *  mesh_level_tx_t *p_tx : outbound stage of the destination
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_dimmer_tx_expire(mesh_level_tx_t *p_tx)
+{
+    TickType_t now = xTaskGetTickCount();
+
+    for(uint8_t i = 0u; i < SWITCH_TX_MAX_IN_FLIGHT; i++)
+    {
+        if((NULL != p_tx->sent[i].p_event) &&
+           (((uint32_t)(now - p_tx->sent[i].send_tick) * portTICK_PERIOD_MS) > MESH_TX_COMPLETE_TIMEOUT_MS))
+        {
+            printf("Mesh client level command to dst:0x%04x not completed, released\r\n", p_tx->dst);
+            p_tx->sent[i].p_event = NULL;
+            p_tx->in_flight--;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_tx_submit
+ *******************************************************************************
+ * Summary:
+ *  Submit a level set command to the outbound stage. The command is sent right
+ *  away if nothing is in flight for the destination. Otherwise it replaces the
+ *  pending command, unless it is final: final commands are never delayed.
+ *
+ * Parameters:
+ *  uint16_t dst : destination address, 0 for the client publication
+ *  wiced_bt_mesh_level_set_level_t *p_data : level to send
+ *  bool is_final : final flag
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_dimmer_tx_submit(uint16_t dst, wiced_bt_mesh_level_set_level_t *p_data, bool is_final)
+{
+    mesh_level_tx_t *p_tx = NULL;
+    uint8_t i;
+
+    mesh_dimmer_tx_lock();
+    for(i = 0; i < SWITCH_TX_MAX_DEST; i++)
+    {
+        if(level_tx[i].in_use)
+        {
+            mesh_dimmer_tx_expire(&level_tx[i]);
+        }
+        if(level_tx[i].in_use && (level_tx[i].dst == dst))
+        {
+            p_tx = &level_tx[i];
+            break;
+        }
+        /* A slot of another destination can be reused once it is idle */
+        if((NULL == p_tx) && (!level_tx[i].in_use || (0u == level_tx[i].in_flight)))
+        {
+            p_tx = &level_tx[i];
+        }
+    }
+    if(NULL == p_tx)
+    {
+        mesh_dimmer_tx_unlock();
+        printf("Mesh client set level failed: no tx slot for dst:0x%04x\r\n", dst);
+        return;
+    }
+    if(!p_tx->in_use || (p_tx->dst != dst))
+    {
+        memset(p_tx, 0, sizeof(*p_tx));
+        p_tx->in_use = true;
+        p_tx->dst = dst;
+    }
+
+    if(p_tx->is_pending)
+    {
+        p_tx->is_pending = false;
+        p_tx->superseded_count++;
+    }
+
+    if(is_final)
+    {
+        p_tx->final_tick = xTaskGetTickCount();
+    }
+
+    if((0u == p_tx->in_flight) || (is_final && (p_tx->in_flight < SWITCH_TX_MAX_IN_FLIGHT)))
+    {
+        mesh_dimmer_tx_send(p_tx, p_data, is_final);
+    }
+    else
+    {
+        p_tx->pending_data = *p_data;
+        p_tx->pending_final = is_final;
+        p_tx->is_pending = true;
+    }
+    mesh_dimmer_tx_unlock();
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_tx_complete
+ *******************************************************************************
+ * Summary:
+ *  Handle the completion of a level command. The delivery statistics of the
+ *  destination are updated, the newest pending command for the destination is
+ *  sent, and the time to deliver the final level is reported once the final
+ *  command completes.
+ *
+ * Parameters:
+ *  wiced_bt_mesh_event_t *p_event : completed event
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_dimmer_tx_complete(wiced_bt_mesh_event_t *p_event)
+{
+    mesh_level_tx_t *p_tx = NULL;
+    mesh_level_tx_send_t *p_send = NULL;
+    uint32_t latency_ms;
+    bool is_delivered;
+    bool is_final;
+
+    mesh_dimmer_tx_lock();
+    for(uint8_t i = 0u; (i < SWITCH_TX_MAX_DEST) && (NULL == p_send); i++)
+    {
+        for(uint8_t j = 0u; j < SWITCH_TX_MAX_IN_FLIGHT; j++)
+        {
+            if(level_tx[i].in_use && (level_tx[i].sent[j].p_event == p_event))
+            {
+                p_tx = &level_tx[i];
+                p_send = &level_tx[i].sent[j];
+                break;
+            }
+        }
+    }
+    /* Not a level set of the outbound stage, a level move for instance */
+    if(NULL == p_send)
+    {
+        mesh_dimmer_tx_unlock();
+        return;
+    }
+    is_final = p_send->is_final;
+    p_send->p_event = NULL;
+
+    /* Latency of this command, not of the newest one sent to the destination */
+    latency_ms = (uint32_t)(xTaskGetTickCount() - p_send->send_tick) * portTICK_PERIOD_MS;
+    APP_LOG2(LEVEL_DELIVERED, p_tx->resolved_dst, latency_ms);
+
+    /* Only acknowledged sends tell whether the level was delivered */
+    if(p_event->reply)
+    {
+        is_delivered = (TX_STATUS_ACK_RECEIVED == p_event->status.tx_flag);
+        p_tx->success_pct = (0u == p_tx->ack_samples) ? (is_delivered ? 100u : 0u) :
+                            (uint8_t)(((uint32_t)p_tx->success_pct * 7u + (is_delivered ? 100u : 0u)) / 8u);
+        if(is_delivered)
+        {
+            p_tx->latency_ms = (0u == p_tx->latency_ms) ? latency_ms :
+                               ((p_tx->latency_ms * 7u + latency_ms) / 8u);
+        }
+        if(p_tx->ack_samples < UINT8_MAX)
+        {
+            p_tx->ack_samples++;
+        }
+    }
+
+    p_tx->in_flight--;
+
+    if(is_final)
+    {
+        APP_LOG3(FINAL_DELIVERED, p_tx->resolved_dst,
+                 (uint32_t)(xTaskGetTickCount() - p_tx->final_tick) * portTICK_PERIOD_MS, p_tx->superseded_count);
+        APP_LOG4(DST_STATS, p_tx->resolved_dst, p_tx->success_pct, p_tx->latency_ms, p_tx->pdu_count);
+        p_tx->superseded_count = 0u;
+    }
+
+    /* A level submitted while the final was in flight is still sent */
+    if(p_tx->is_pending &&
+       ((0u == p_tx->in_flight) || (p_tx->pending_final && (p_tx->in_flight < SWITCH_TX_MAX_IN_FLIGHT))))
+    {
+        p_tx->is_pending = false;
+        mesh_dimmer_tx_send(p_tx, &p_tx->pending_data, p_tx->pending_final);
+    }
+    mesh_dimmer_tx_unlock();
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_send_move
+ *******************************************************************************
+ * Summary:
+ *  Send a Generic Level Move to the destination.
+ *
+ * Parameters:
+ *  uint16_t dst : destination address, 0 for the client publication
+ *  wiced_bt_mesh_level_set_move_t *p_data : move to send
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_dimmer_send_move(uint16_t dst, wiced_bt_mesh_level_set_move_t *p_data)
+{
+    wiced_bt_mesh_event_t *p_event;
+
+    p_event = wiced_bt_mesh_create_event(MESH_LEVEL_CLIENT_ELEMENT_INDEX, MESH_COMPANY_ID_BT_SIG,
+                                         WICED_BT_MESH_CORE_MODEL_ID_GENERIC_LEVEL_CLNT, dst, 0);
+    if(NULL == p_event)
+    {
+        printf("Mesh client move failed: no destination\r\n");
+        return;
+    }
+
+    if(WICED_BT_SUCCESS == wiced_bt_mesh_model_level_client_send_move_set(p_event, p_data))
+    {
+        ramp_msg_count++;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_fanout_next
+ *******************************************************************************
+ * Summary:
+ *  Send the fan-out command to the next destination and start the pacing
+ *  timer if destinations are left.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_dimmer_fanout_next(void)
+{
+    uint16_t dst;
+
+    mesh_dimmer_tx_lock();
+    if(fanout.next >= fanout.num_dst)
+    {
+        mesh_dimmer_tx_unlock();
+        return;
+    }
+    dst = fanout.dst[fanout.next];
+
+    if(fanout.is_move)
+    {
+        fanout.move_data.delay = fanout.delay_ms[fanout.next];
+        mesh_dimmer_send_move(dst, &fanout.move_data);
+    }
+    else
+    {
+        fanout.set_data.delay = fanout.delay_ms[fanout.next];
+        mesh_dimmer_tx_submit(dst, &fanout.set_data, fanout.is_final);
+    }
+    fanout.next++;
+
+    if(fanout.next < fanout.num_dst)
+    {
+        xTimerStart(fanout_timer, 0u);
+    }
+    mesh_dimmer_tx_unlock();
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_dst_latency_ms
+ *******************************************************************************
+ * Summary:
+ *  Measured acknowledged delivery latency of a destination.
+ *
+ * Parameters:
+ *  uint16_t dst : destination address
+ *
+ * Return:
+ *  uint32_t : latency in milliseconds, 0 if not measured
+ *
+ ******************************************************************************/
+static uint32_t mesh_dimmer_dst_latency_ms(uint16_t dst)
+{
+    for(uint8_t i = 0u; i < SWITCH_TX_MAX_DEST; i++)
+    {
+        if(level_tx[i].in_use && (level_tx[i].dst == dst))
+        {
+            return level_tx[i].latency_ms;
+        }
+    }
+    return 0u;
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_fanout_align
+ *******************************************************************************
+ * Summary:
+ *  Compute the delay of every fan-out destination so that all of them start
+ *  the transition together. A destination is expected to receive the command
+ *  after its pacing offset in the send order plus its measured latency; the
+ *  earlier ones are delayed up to the latest expected arrival, in steps of
+ *  the 5 ms delay resolution of the mesh messages.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_dimmer_fanout_align(void)
+{
+    uint32_t arrival_ms[MESH_FANOUT_MAX_DST];
+    uint32_t latest_ms = 0u;
+    uint32_t delay_ms;
+    uint8_t i;
+
+    for(i = 0u; i < fanout.num_dst; i++)
+    {
+        arrival_ms[i] = (uint32_t)i * MESH_FANOUT_PACING_MS + mesh_dimmer_dst_latency_ms(fanout.dst[i]);
+        latest_ms = (arrival_ms[i] > latest_ms) ? arrival_ms[i] : latest_ms;
+    }
+
+    for(i = 0u; i < fanout.num_dst; i++)
+    {
+#if MESH_FANOUT_ALIGN_START
+        delay_ms = ((latest_ms - arrival_ms[i]) / SWITCH_DELAY_STEP_MS) * SWITCH_DELAY_STEP_MS;
+        delay_ms = (delay_ms > SWITCH_DELAY_MAX_MS) ? SWITCH_DELAY_MAX_MS : delay_ms;
+#else
+        delay_ms = 0u;
+#endif
+        fanout.delay_ms[i] = (uint16_t)delay_ms;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_fanout_status
+ *******************************************************************************
+ * Summary:
+ *  Measure the spread of the transition starts of a final fan-out level from
+ *  the status replies. A destination ends its transition the remaining time
+ *  of its status after it sent the status, which is taken as half of its
+ *  measured round trip before the reply is received. All destinations run
+ *  the same transition time, so the spread of the ends is the spread of the
+ *  starts. It is reported once every destination has replied; destinations
+ *  that were sent the level unacknowledged do not reply, and then no spread
+ *  is reported.
+ *
+ * Parameters:
+ *  uint16_t src : address of the server
+ *  uint32_t remaining_ms : remaining time of the transition in the status
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_dimmer_fanout_status(uint16_t src, uint32_t remaining_ms)
+{
+    uint16_t all_mask = (uint16_t)((1u << fanout.num_dst) - 1u);
+    TickType_t now = xTaskGetTickCount();
+    TickType_t first_tick;
+    TickType_t last_tick;
+    uint8_t i;
+
+    mesh_dimmer_tx_lock();
+    if(fanout.is_move || !fanout.is_final || (fanout.num_dst < 2u) || (fanout.status_mask == all_mask))
+    {
+        mesh_dimmer_tx_unlock();
+        return;
+    }
+    for(i = 0u; i < fanout.num_dst; i++)
+    {
+        if((fanout.dst[i] == src) && (0u == (fanout.status_mask & (1u << i))))
+        {
+            fanout.end_tick[i] = now + pdMS_TO_TICKS(remaining_ms) -
+                                 pdMS_TO_TICKS(mesh_dimmer_dst_latency_ms(src) / 2u);
+            fanout.status_mask |= (uint16_t)(1u << i);
+            break;
+        }
+    }
+    if(fanout.status_mask != all_mask)
+    {
+        mesh_dimmer_tx_unlock();
+        return;
+    }
+
+    first_tick = fanout.end_tick[0];
+    last_tick = fanout.end_tick[0];
+    for(i = 1u; i < fanout.num_dst; i++)
+    {
+        first_tick = ((int32_t)(fanout.end_tick[i] - first_tick) < 0) ? fanout.end_tick[i] : first_tick;
+        last_tick = ((int32_t)(fanout.end_tick[i] - last_tick) > 0) ? fanout.end_tick[i] : last_tick;
+    }
+    mesh_dimmer_tx_unlock();
+
+    APP_LOG2(FANOUT_SPREAD, (uint32_t)(last_tick - first_tick) * portTICK_PERIOD_MS, fanout.num_dst);
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_fanout_start
+ *******************************************************************************
+ * Summary:
+ *  Send a level set or a level move to all fan-out destinations, or to the
+ *  client publication if no destinations are configured. A fan-out still in
+ *  progress is restarted with the new command.
+ *
+ * Parameters:
+ *  wiced_bt_mesh_level_set_level_t *p_set_data : level to send, or NULL
+ *  wiced_bt_mesh_level_set_move_t *p_move_data : move to send, or NULL
+ *  bool is_final : final flag of the level set
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_dimmer_fanout_start(wiced_bt_mesh_level_set_level_t *p_set_data,
+                                     wiced_bt_mesh_level_set_move_t *p_move_data, bool is_final)
+{
+    mesh_dimmer_tx_lock();
+    if(0u == fanout.num_dst)
+    {
+        if(NULL != p_move_data)
+        {
+            mesh_dimmer_send_move(0, p_move_data);
+        }
+        else
+        {
+            mesh_dimmer_tx_submit(0, p_set_data, is_final);
+        }
+        mesh_dimmer_tx_unlock();
+        return;
+    }
+
+    xTimerStop(fanout_timer, 0u);
+
+    fanout.is_move = (NULL != p_move_data);
+    fanout.is_final = is_final;
+    if(fanout.is_move)
+    {
+        fanout.move_data = *p_move_data;
+    }
+    else
+    {
+        fanout.set_data = *p_set_data;
+    }
+    fanout.next = 0u;
+    fanout.status_mask = 0u;
+    mesh_dimmer_fanout_align();
+
+    mesh_dimmer_fanout_next();
+    mesh_dimmer_tx_unlock();
+}
+
+/*******************************************************************************
+ * Function Name: mesh_dimmer_fanout_timer_cb
+ *******************************************************************************
+ * Summary:
+ *  Fan-out pacing timer callback.
+ *
+ * Parameters:
+ *  TimerHandle_t timer_handle: Unused
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void mesh_dimmer_fanout_timer_cb(TimerHandle_t timer_handle)
+{
+    mesh_dimmer_fanout_next();
+}
 
 /* [] END OF FILE */
\ No newline at end of file
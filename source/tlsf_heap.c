@@ -0,0 +1,446 @@
+/*******************************************************************************
+* File Name: tlsf_heap.c
+*
+* Description: This file contains a two level segregated fit (TLSF) heap.
+*              Allocation and release take a bounded time whatever the heap
+*              state, and neighbouring free blocks are merged on release.
+*              The file has no platform dependency, so an allocation trace
+*              captured on the device can be replayed on a host.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <string.h>
+#include "tlsf_heap.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define TLSF_ALIGN                      (1u << TLSF_ALIGN_LOG2)
+#define TLSF_SMALL_BLOCK                (1u << TLSF_FL_SHIFT)
+
+/* The size field keeps the payload size, its low bit marks a free block */
+#define TLSF_FREE_BIT                   (1u)
+#define TLSF_SIZE_MASK                  (~(size_t)(TLSF_ALIGN - 1u))
+
+/* A used block only carries the physical link and the size */
+#define TLSF_BLOCK_OVERHEAD             (offsetof(tlsf_block_t, next_free))
+#define TLSF_MIN_PAYLOAD                (sizeof(tlsf_block_t) - TLSF_BLOCK_OVERHEAD)
+
+/*******************************************************************************
+ * Variables Definitions
+ ******************************************************************************/
+struct tlsf_block
+{
+    tlsf_block_t *prev_phys;                    /* block before this one in memory */
+    size_t size;                                /* payload size and TLSF_FREE_BIT */
+    tlsf_block_t *next_free;                    /* free list links, payload of a used block */
+    tlsf_block_t *prev_free;
+};
+
+/*******************************************************************************
+ * Function Name: tlsf_fls
+ *******************************************************************************
+ * Summary:
+ *  Index of the most significant set bit.
+ *
+ * Parameters:
+ *  size_t value : non zero value
+ *
+ * Return:
+ *  uint32_t : bit index
+ *
+ ******************************************************************************/
+static inline uint32_t tlsf_fls(size_t value)
+{
+    return 31u - (uint32_t)__builtin_clz((uint32_t)value);
+}
+
+/*******************************************************************************
+ * Function Name: tlsf_block_size
+ *******************************************************************************
+ * Summary:
+ *  Payload size of a block.
+ *
+ * Parameters:
+ *  const tlsf_block_t *p_block : block
+ *
+ * Return:
+ *  size_t : payload size
+ *
+ ******************************************************************************/
+static inline size_t tlsf_block_size(const tlsf_block_t *p_block)
+{
+    return p_block->size & TLSF_SIZE_MASK;
+}
+
+/*******************************************************************************
+ * Function Name: tlsf_block_next
+ *******************************************************************************
+ * Summary:
+ *  Block after this one in memory.
+ *
+ * Parameters:
+ *  tlsf_block_t *p_block : block
+ *
+ * Return:
+ *  tlsf_block_t * : next block, the end sentinel for the last one
+ *
+ ******************************************************************************/
+static inline tlsf_block_t *tlsf_block_next(tlsf_block_t *p_block)
+{
+    return (tlsf_block_t *)((uint8_t *)p_block + TLSF_BLOCK_OVERHEAD + tlsf_block_size(p_block));
+}
+
+/*******************************************************************************
+ * Function Name: tlsf_mapping
+ *******************************************************************************
+ * Summary:
+ *  First and second level indexes of the list holding a size.
+ *
+ * Parameters:
+ *  size_t size : payload size
+ *  uint32_t *p_fl : first level index
+ *  uint32_t *p_sl : second level index
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void tlsf_mapping(size_t size, uint32_t *p_fl, uint32_t *p_sl)
+{
+    uint32_t msb;
+
+    if(size < TLSF_SMALL_BLOCK)
+    {
+        *p_fl = 0u;
+        *p_sl = (uint32_t)(size / (TLSF_SMALL_BLOCK / TLSF_SL_COUNT));
+    }
+    else
+    {
+        msb = tlsf_fls(size);
+        *p_fl = msb - TLSF_FL_SHIFT + 1u;
+        *p_sl = (uint32_t)(size >> (msb - TLSF_SL_LOG2)) ^ TLSF_SL_COUNT;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: tlsf_insert
+ *******************************************************************************
+ * Summary:
+ *  Mark a block free and put it at the head of its list.
+ *
+ * Parameters:
+ *  tlsf_heap_t *p_heap : heap
+ *  tlsf_block_t *p_block : block
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void tlsf_insert(tlsf_heap_t *p_heap, tlsf_block_t *p_block)
+{
+    uint32_t fl;
+    uint32_t sl;
+
+    tlsf_mapping(tlsf_block_size(p_block), &fl, &sl);
+    p_block->size |= TLSF_FREE_BIT;
+    p_block->prev_free = NULL;
+    p_block->next_free = p_heap->free_list[fl][sl];
+    if(NULL != p_block->next_free)
+    {
+        p_block->next_free->prev_free = p_block;
+    }
+    p_heap->free_list[fl][sl] = p_block;
+    p_heap->fl_bitmap |= (1uL << fl);
+    p_heap->sl_bitmap[fl] |= (1uL << sl);
+}
+
+/*******************************************************************************
+ * Function Name: tlsf_remove
+ *******************************************************************************
+ * Summary:
+ *  Take a free block out of its list and mark it used.
+ *
+ * Parameters:
+ *  tlsf_heap_t *p_heap : heap
+ *  tlsf_block_t *p_block : block
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void tlsf_remove(tlsf_heap_t *p_heap, tlsf_block_t *p_block)
+{
+    uint32_t fl;
+    uint32_t sl;
+
+    tlsf_mapping(tlsf_block_size(p_block), &fl, &sl);
+    if(NULL != p_block->next_free)
+    {
+        p_block->next_free->prev_free = p_block->prev_free;
+    }
+    if(NULL != p_block->prev_free)
+    {
+        p_block->prev_free->next_free = p_block->next_free;
+    }
+    else
+    {
+        p_heap->free_list[fl][sl] = p_block->next_free;
+        if(NULL == p_block->next_free)
+        {
+            p_heap->sl_bitmap[fl] &= ~(1uL << sl);
+            if(0u == p_heap->sl_bitmap[fl])
+            {
+                p_heap->fl_bitmap &= ~(1uL << fl);
+            }
+        }
+    }
+    p_block->size &= ~(size_t)TLSF_FREE_BIT;
+}
+
+/*******************************************************************************
+ * Function Name: tlsf_heap_init
+ *******************************************************************************
+ * Summary:
+ *  Create a heap in a memory area. The area holds one free block followed
+ *  by a used sentinel of zero size.
+ *
+ * Parameters:
+ *  tlsf_heap_t *p_heap : heap
+ *  void *p_mem : memory area, 8 byte aligned
+ *  size_t size : size of the area, below 2^TLSF_FL_MAX_LOG2 bytes
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void tlsf_heap_init(tlsf_heap_t *p_heap, void *p_mem, size_t size)
+{
+    tlsf_block_t *p_block = (tlsf_block_t *)p_mem;
+    tlsf_block_t *p_sentinel;
+
+    memset(p_heap, 0, sizeof(*p_heap));
+
+    size = (size - (2u * TLSF_BLOCK_OVERHEAD)) & TLSF_SIZE_MASK;
+    p_block->prev_phys = NULL;
+    p_block->size = size;
+
+    p_sentinel = tlsf_block_next(p_block);
+    p_sentinel->prev_phys = p_block;
+    p_sentinel->size = 0u;
+
+    tlsf_insert(p_heap, p_block);
+    p_heap->size = size;
+    p_heap->free_bytes = size;
+    p_heap->min_free_bytes = size;
+}
+
+/*******************************************************************************
+ * Function Name: tlsf_heap_alloc
+ *******************************************************************************
+ * Summary:
+ *  Allocate from the first non-empty list whose every block fits the
+ *  request. The remainder of the block is returned to the heap.
+ *
+ * Parameters:
+ *  tlsf_heap_t *p_heap : heap
+ *  size_t size : requested bytes
+ *
+ * Return:
+ *  void * : buffer, NULL if no block fits
+ *
+ ******************************************************************************/
+void *tlsf_heap_alloc(tlsf_heap_t *p_heap, size_t size)
+{
+    tlsf_block_t *p_block;
+    tlsf_block_t *p_rest;
+    tlsf_block_t *p_next;
+    uint32_t fl;
+    uint32_t sl;
+    uint32_t sl_map;
+    uint32_t fl_map;
+
+    if((0u == size) || (size > p_heap->size))
+    {
+        return NULL;
+    }
+    size = (size + TLSF_ALIGN - 1u) & TLSF_SIZE_MASK;
+    if(size < TLSF_MIN_PAYLOAD)
+    {
+        size = TLSF_MIN_PAYLOAD;
+    }
+
+    /* Round up to the next list, so any block of the list found fits */
+    if(size >= TLSF_SMALL_BLOCK)
+    {
+        tlsf_mapping(size + (1u << (tlsf_fls(size) - TLSF_SL_LOG2)) - 1u, &fl, &sl);
+    }
+    else
+    {
+        tlsf_mapping(size, &fl, &sl);
+    }
+    if(fl >= TLSF_FL_COUNT)
+    {
+        return NULL;
+    }
+
+    sl_map = p_heap->sl_bitmap[fl] & (~0uL << sl);
+    if(0u == sl_map)
+    {
+        fl_map = (fl + 1u < 32u) ? (p_heap->fl_bitmap & (~0uL << (fl + 1u))) : 0u;
+        if(0u == fl_map)
+        {
+            return NULL;
+        }
+        fl = (uint32_t)__builtin_ctz(fl_map);
+        sl_map = p_heap->sl_bitmap[fl];
+    }
+    sl = (uint32_t)__builtin_ctz(sl_map);
+
+    p_block = p_heap->free_list[fl][sl];
+    tlsf_remove(p_heap, p_block);
+
+    /* Split when the rest can hold a block of its own */
+    if(tlsf_block_size(p_block) >= (size + sizeof(tlsf_block_t)))
+    {
+        p_rest = (tlsf_block_t *)((uint8_t *)p_block + TLSF_BLOCK_OVERHEAD + size);
+        p_rest->prev_phys = p_block;
+        p_rest->size = tlsf_block_size(p_block) - size - TLSF_BLOCK_OVERHEAD;
+        p_block->size = size;
+
+        p_next = tlsf_block_next(p_rest);
+        p_next->prev_phys = p_rest;
+        tlsf_insert(p_heap, p_rest);
+        p_heap->free_bytes -= TLSF_BLOCK_OVERHEAD;
+    }
+
+    p_heap->free_bytes -= tlsf_block_size(p_block);
+    if(p_heap->free_bytes < p_heap->min_free_bytes)
+    {
+        p_heap->min_free_bytes = p_heap->free_bytes;
+    }
+    return (uint8_t *)p_block + TLSF_BLOCK_OVERHEAD;
+}
+
+/*******************************************************************************
+ * Function Name: tlsf_heap_free
+ *******************************************************************************
+ * Summary:
+ *  Release a buffer, merging it with the free blocks next to it in memory.
+ *
+ * Parameters:
+ *  tlsf_heap_t *p_heap : heap
+ *  void *p_buf : buffer of tlsf_heap_alloc(), or NULL
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+void tlsf_heap_free(tlsf_heap_t *p_heap, void *p_buf)
+{
+    tlsf_block_t *p_block;
+    tlsf_block_t *p_prev;
+    tlsf_block_t *p_next;
+
+    if(NULL == p_buf)
+    {
+        return;
+    }
+    p_block = (tlsf_block_t *)((uint8_t *)p_buf - TLSF_BLOCK_OVERHEAD);
+    p_heap->free_bytes += tlsf_block_size(p_block);
+
+    p_prev = p_block->prev_phys;
+    if((NULL != p_prev) && (0u != (p_prev->size & TLSF_FREE_BIT)))
+    {
+        tlsf_remove(p_heap, p_prev);
+        p_prev->size += TLSF_BLOCK_OVERHEAD + tlsf_block_size(p_block);
+        p_heap->free_bytes += TLSF_BLOCK_OVERHEAD;
+        p_block = p_prev;
+    }
+
+    p_next = tlsf_block_next(p_block);
+    if(0u != (p_next->size & TLSF_FREE_BIT))
+    {
+        tlsf_remove(p_heap, p_next);
+        p_block->size += TLSF_BLOCK_OVERHEAD + tlsf_block_size(p_next);
+        p_heap->free_bytes += TLSF_BLOCK_OVERHEAD;
+    }
+
+    tlsf_block_next(p_block)->prev_phys = p_block;
+    tlsf_insert(p_heap, p_block);
+}
+
+/*******************************************************************************
+ * Function Name: tlsf_heap_largest_free
+ *******************************************************************************
+ * Summary:
+ *  Size of the largest free block. Only the highest non-empty list is
+ *  searched.
+ *
+ * Parameters:
+ *  const tlsf_heap_t *p_heap : heap
+ *
+ * Return:
+ *  size_t : payload size of the largest free block, 0 if none
+ *
+ ******************************************************************************/
+size_t tlsf_heap_largest_free(const tlsf_heap_t *p_heap)
+{
+    const tlsf_block_t *p_block;
+    size_t largest = 0u;
+    uint32_t fl;
+    uint32_t sl;
+
+    if(0u == p_heap->fl_bitmap)
+    {
+        return 0u;
+    }
+    fl = tlsf_fls(p_heap->fl_bitmap);
+    sl = tlsf_fls(p_heap->sl_bitmap[fl]);
+    for(p_block = p_heap->free_list[fl][sl]; NULL != p_block; p_block = p_block->next_free)
+    {
+        if(tlsf_block_size(p_block) > largest)
+        {
+            largest = tlsf_block_size(p_block);
+        }
+    }
+    return largest;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,87 @@
+/*******************************************************************************
+* File Name: tlsf_heap.h
+*
+* Description: This file is the public interface of tlsf_heap.c
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Include guard
+ ******************************************************************************/
+#ifndef TLSF_HEAP_H_
+#define TLSF_HEAP_H_
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include "stdint.h"
+#include "stddef.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define TLSF_ALIGN_LOG2                 (3u)    /* 8 byte alignment */
+#define TLSF_SL_LOG2                    (3u)    /* 8 second level lists per first level */
+#define TLSF_FL_MAX_LOG2                (17u)   /* blocks up to 128 KB */
+
+#define TLSF_FL_SHIFT                   (TLSF_SL_LOG2 + TLSF_ALIGN_LOG2)
+#define TLSF_FL_COUNT                   (TLSF_FL_MAX_LOG2 - TLSF_FL_SHIFT + 1u)
+#define TLSF_SL_COUNT                   (1u << TLSF_SL_LOG2)
+
+typedef struct tlsf_block tlsf_block_t;
+
+/* Two level segregated fit heap. The free blocks are kept in lists by size
+ * class, the bitmaps find the first non-empty class that fits with two bit
+ * scans, so allocation and release do not depend on the number of blocks. */
+typedef struct
+{
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[TLSF_FL_COUNT];
+    tlsf_block_t *free_list[TLSF_FL_COUNT][TLSF_SL_COUNT];
+    size_t size;                                /* usable bytes of the arena */
+    size_t free_bytes;
+    size_t min_free_bytes;                      /* lowest free_bytes since creation */
+} tlsf_heap_t;
+
+/*******************************************************************************
+ * Function Prototypes
+ ******************************************************************************/
+void tlsf_heap_init(tlsf_heap_t *p_heap, void *p_mem, size_t size);
+void *tlsf_heap_alloc(tlsf_heap_t *p_heap, size_t size);
+void tlsf_heap_free(tlsf_heap_t *p_heap, void *p_buf);
+size_t tlsf_heap_largest_free(const tlsf_heap_t *p_heap);
+
+#endif /* TLSF_HEAP_H_ */
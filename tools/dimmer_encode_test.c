@@ -0,0 +1,283 @@
+/*******************************************************************************
+* File Name: dimmer_encode_test.c
+*
+* Description: Host test of the level and lightness conversions of
+*              dimmer_encode.c. It checks the Generic Level to Lightness
+*              Actual round trip over the whole range, the Lightness Linear
+*              round trip, the end points of every conversion, and the
+*              integer square root against its definition for every
+*              Lightness Linear value, and the warm dimming CTL temperature
+*              at its end points and for monotonicity. The exit status is
+*              the number of failed checks.
+*
+*              Build and run on the host:
+*                gcc -O2 -Isource tools/dimmer_encode_test.c source/dimmer_encode.c -o dimmer_encode_test
+*                ./dimmer_encode_test
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdio.h>
+#include <stdint.h>
+#include "dimmer_encode.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define TEST_LIGHTNESS_MAX              (65535u)
+
+/* Reports the first few failures of a check, all of them are counted */
+#define TEST_MAX_REPORTS                (8u)
+
+/*******************************************************************************
+ * Variables Definitions
+ ******************************************************************************/
+static unsigned int test_failures = 0u;
+static unsigned int test_checks = 0u;
+
+/*******************************************************************************
+ * Function Name: test_expect
+ *******************************************************************************
+ * Summary:
+ *  Count a check and report it when it fails.
+ *
+ * Parameters:
+ *  int is_ok : result of the check
+ *  const char *name : check
+ *  long input : value checked
+ *  long got : value returned
+ *  long expected : value expected
+ *
+ * Return:
+ *  None
+ *
+ ******************************************************************************/
+static void test_expect(int is_ok, const char *name, long input, long got, long expected)
+{
+    test_checks++;
+    if(is_ok)
+    {
+        return;
+    }
+    if(test_failures < TEST_MAX_REPORTS)
+    {
+        printf("FAIL %s(%ld) = %ld, expected %ld\n", name, input, got, expected);
+    }
+    test_failures++;
+}
+
+/*******************************************************************************
+ * Function Name: test_end_points
+ *******************************************************************************
+ * Summary:
+ *  Conversions at the ends and the middle of the ranges.
+ *
+ ******************************************************************************/
+static void test_end_points(void)
+{
+    test_expect(0x0000u == dimmer_encode_lightness_actual(-32768), "encode_actual", -32768,
+                dimmer_encode_lightness_actual(-32768), 0x0000);
+    test_expect(0x8000u == dimmer_encode_lightness_actual(0), "encode_actual", 0,
+                dimmer_encode_lightness_actual(0), 0x8000);
+    test_expect(0xFFFFu == dimmer_encode_lightness_actual(32767), "encode_actual", 32767,
+                dimmer_encode_lightness_actual(32767), 0xFFFF);
+
+    test_expect(-32768 == dimmer_decode_lightness_actual(0x0000u), "decode_actual", 0x0000,
+                dimmer_decode_lightness_actual(0x0000u), -32768);
+    test_expect(32767 == dimmer_decode_lightness_actual(0xFFFFu), "decode_actual", 0xFFFF,
+                dimmer_decode_lightness_actual(0xFFFFu), 32767);
+
+    test_expect(0x0000u == dimmer_encode_lightness_linear(0x0000u), "encode_linear", 0x0000,
+                dimmer_encode_lightness_linear(0x0000u), 0x0000);
+    test_expect(0xFFFFu == dimmer_encode_lightness_linear(0xFFFFu), "encode_linear", 0xFFFF,
+                dimmer_encode_lightness_linear(0xFFFFu), 0xFFFF);
+    /* The smallest non-zero Actual still gives a non-zero Linear, rounded up */
+    test_expect(0x0001u == dimmer_encode_lightness_linear(0x0001u), "encode_linear", 0x0001,
+                dimmer_encode_lightness_linear(0x0001u), 0x0001);
+
+    test_expect(0x0000u == dimmer_decode_lightness_linear(0x0000u), "decode_linear", 0x0000,
+                dimmer_decode_lightness_linear(0x0000u), 0x0000);
+    test_expect(0xFFFFu == dimmer_decode_lightness_linear(0xFFFFu), "decode_linear", 0xFFFF,
+                dimmer_decode_lightness_linear(0xFFFFu), 0xFFFF);
+}
+
+/*******************************************************************************
+ * Function Name: test_actual_round_trip
+ *******************************************************************************
+ * Summary:
+ *  Every Generic Level survives the round trip through Lightness Actual, and
+ *  the Actual value grows with the level.
+ *
+ ******************************************************************************/
+static void test_actual_round_trip(void)
+{
+    uint16_t actual;
+
+    for(int32_t level = -32768; level <= 32767; level++)
+    {
+        actual = dimmer_encode_lightness_actual((int16_t)level);
+        test_expect(dimmer_decode_lightness_actual(actual) == level, "decode_actual(encode_actual)", level,
+                    dimmer_decode_lightness_actual(actual), level);
+        test_expect(actual == (uint16_t)(level + 32768), "encode_actual", level, actual, level + 32768);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: test_linear_round_trip
+ *******************************************************************************
+ * Summary:
+ *  Lightness Actual to Linear and back: the Linear value is kept exactly, the
+ *  Actual value never comes back lower, and both conversions are monotonic.
+ *  Low Actual values share a Linear value, so the Actual value may come back
+ *  higher.
+ *
+ ******************************************************************************/
+static void test_linear_round_trip(void)
+{
+    uint16_t linear;
+    uint16_t actual;
+    uint16_t previous_linear = 0u;
+    uint16_t previous_actual = 0u;
+
+    for(uint32_t value = 0u; value <= TEST_LIGHTNESS_MAX; value++)
+    {
+        linear = dimmer_encode_lightness_linear((uint16_t)value);
+        actual = dimmer_decode_lightness_linear(linear);
+        test_expect(actual >= value, "decode_linear(encode_linear)", (long)value, actual, (long)value);
+        test_expect(dimmer_encode_lightness_linear(actual) == linear, "encode_linear(decode_linear)", linear,
+                    dimmer_encode_lightness_linear(actual), linear);
+        test_expect(linear >= previous_linear, "encode_linear monotonic", (long)value, linear, previous_linear);
+        previous_linear = linear;
+
+        actual = dimmer_decode_lightness_linear((uint16_t)value);
+        test_expect(actual >= previous_actual, "decode_linear monotonic", (long)value, actual, previous_actual);
+        previous_actual = actual;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: test_isqrt
+ *******************************************************************************
+ * Summary:
+ *  The Linear decoding is floor(sqrt(Linear * 65535)). Check the root of
+ *  every Linear value against root^2 <= x < (root + 1)^2, which covers the
+ *  perfect squares, the values just below them, and the top of the 32 bit
+ *  range.
+ *
+ ******************************************************************************/
+static void test_isqrt(void)
+{
+    uint64_t x;
+    uint64_t root;
+
+    for(uint32_t linear = 0u; linear <= TEST_LIGHTNESS_MAX; linear++)
+    {
+        x = (uint64_t)linear * TEST_LIGHTNESS_MAX;
+        root = dimmer_decode_lightness_linear((uint16_t)linear);
+        test_expect(((root * root) <= x) && (((root + 1u) * (root + 1u)) > x), "isqrt", (long)x, (long)root,
+                    (long)root);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: test_ctl_temperature
+ *******************************************************************************
+ * Summary:
+ *  Warm dimming: the temperature is the minimum at lightness 0, the maximum
+ *  at full lightness, stays in the range and never drops as the lightness
+ *  grows. An empty or inverted range gives the minimum. The ranges cover a
+ *  typical warm dimming range and the full Light CTL range of 800 K to
+ *  20000 K.
+ *
+ ******************************************************************************/
+static void test_ctl_temperature(void)
+{
+    static const uint16_t range[][2] = { { 2700u, 6500u }, { 800u, 20000u }, { 2700u, 2701u } };
+    uint16_t temperature;
+    uint16_t previous;
+    uint16_t t_min;
+    uint16_t t_max;
+
+    for(uint32_t i = 0u; i < (sizeof(range) / sizeof(range[0])); i++)
+    {
+        t_min = range[i][0];
+        t_max = range[i][1];
+
+        temperature = dimmer_encode_ctl_temperature(0x0000u, t_min, t_max);
+        test_expect(temperature == t_min, "ctl_temperature min", 0x0000, temperature, t_min);
+        temperature = dimmer_encode_ctl_temperature(0xFFFFu, t_min, t_max);
+        test_expect(temperature == t_max, "ctl_temperature max", 0xFFFF, temperature, t_max);
+
+        previous = t_min;
+        for(uint32_t actual = 0u; actual <= TEST_LIGHTNESS_MAX; actual++)
+        {
+            temperature = dimmer_encode_ctl_temperature((uint16_t)actual, t_min, t_max);
+            test_expect((temperature >= t_min) && (temperature <= t_max), "ctl_temperature range", (long)actual,
+                        temperature, t_min);
+            test_expect(temperature >= previous, "ctl_temperature monotonic", (long)actual, temperature, previous);
+            previous = temperature;
+        }
+
+        /* Inverted and empty ranges */
+        temperature = dimmer_encode_ctl_temperature(0xFFFFu, t_max, t_min);
+        test_expect(temperature == t_max, "ctl_temperature inverted", 0xFFFF, temperature, t_max);
+        temperature = dimmer_encode_ctl_temperature(0xFFFFu, t_min, t_min);
+        test_expect(temperature == t_min, "ctl_temperature empty", 0xFFFF, temperature, t_min);
+    }
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *  Run the checks and print the result.
+ *
+ ******************************************************************************/
+int main(void)
+{
+    test_end_points();
+    test_actual_round_trip();
+    test_linear_round_trip();
+    test_isqrt();
+    test_ctl_temperature();
+
+    printf("%s: %u of %u checks failed\n", (0u == test_failures) ? "PASS" : "FAIL", test_failures, test_checks);
+    return (test_failures > 255u) ? 255 : (int)test_failures;
+}
+
+/* [] END OF FILE */
@@ -0,0 +1,873 @@
+/*******************************************************************************
+* File Name: heap_replay.c
+*
+* Description: Host tool replaying a FreeRTOS heap allocation trace captured
+*              on the device (rtos_heap_trace_dump(), "HT" lines of the debug
+*              UART log) through the three heaps RTOS_HEAP selects: TLSF, a
+*              model of FreeRTOS heap_4, and a model of the newlib-nano malloc
+*              behind heap_3. It prints the latency percentiles of every
+*              heap, the device latencies recorded in the trace, and the worst
+*              fragmentation, lowest free space and failed allocations of
+*              every heap.
+*
+*              Build and run on the host:
+*                gcc -O2 -Isource tools/heap_replay.c source/tlsf_heap.c -o heap_replay
+*                ./heap_replay < uart.log
+*
+*              The heap_4 and newlib-nano models keep 32-bit offsets, so their
+*              block headers and alignment are those of the device. The host
+*              TLSF headers hold two pointers and are 8 bytes larger per block
+*              than on the device, so TLSF gets 8 more bytes for every block
+*              the trace keeps live at the same time and for every free block
+*              between them. The latencies are host latencies and only compare
+*              the heaps with each other.
+*
+* Related Document: See README.md
+*
+********************************************************************************
+* Copyright 2022, Cypress Semiconductor Corporation (an Infineon company) or
+* an affiliate of Cypress Semiconductor Corporation.  All rights reserved.
+*
+* This software, including source code, documentation and related
+* materials ("Software") is owned by Cypress Semiconductor Corporation
+* or one of its affiliates ("Cypress") and is protected by and subject to
+* worldwide patent protection (United States and foreign),
+* United States copyright laws and international treaty provisions.
+* Therefore, you may use this Software only as provided in the license
+* agreement accompanying the software package from which you
+* obtained this Software ("EULA").
+* If no EULA applies, Cypress hereby grants you a personal, non-exclusive,
+* non-transferable license to copy, modify, and compile the Software
+* source code solely for use in connection with Cypress's
+* integrated circuit products.  Any reproduction, modification, translation,
+* compilation, or representation of this Software except as specified
+* above is prohibited without the express written permission of Cypress.
+*
+* Disclaimer: THIS SOFTWARE IS PROVIDED AS-IS, WITH NO WARRANTY OF ANY KIND,
+* EXPRESS OR IMPLIED, INCLUDING, BUT NOT LIMITED TO, NONINFRINGEMENT, IMPLIED
+* WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE. Cypress
+* reserves the right to make changes to the Software without notice. Cypress
+* does not assume any liability arising out of the application or use of the
+* Software or any product or circuit described in the Software. Cypress does
+* not authorize its products for use in any products where a malfunction or
+* failure of the Cypress product may reasonably be expected to result in
+* significant property damage, injury or death ("High Risk Product"). By
+* including Cypress's product in a High Risk Product, the manufacturer
+* of such system or application assumes all risk of such use and in doing
+* so agrees to indemnify Cypress against all liability.
+*******************************************************************************/
+
+/*******************************************************************************
+ * Header file includes
+ ******************************************************************************/
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "tlsf_heap.h"
+
+/*******************************************************************************
+ * Macros
+ ******************************************************************************/
+#define REPLAY_MAX_OPS                  (65536u)
+#define REPLAY_MAX_LIVE                 (4096u)
+#define REPLAY_DEFAULT_HEAP_SIZE        (50u * 1024u)
+#define REPLAY_ARENA_SIZE               (4u * 65536u)
+#define REPLAY_NUM_HEAPS                (3u)
+
+/* TLSF header bytes of a host block above the device ones, prev_phys and size */
+#define REPLAY_TLSF_EXTRA_HEADER        (2u * (sizeof(void *) - sizeof(uint32_t)))
+
+/* Models use offsets into their arena, MODEL_NONE is the NULL offset */
+#define MODEL_NONE                      (UINT32_MAX)
+#define MODEL_START                     (UINT32_MAX - 1u)
+
+/* FreeRTOS heap_4 on a 32-bit device: 8 byte BlockLink_t, 8 byte alignment,
+ * the MSB of the size marks an allocated block */
+#define HEAP4_HEADER                    (8u)
+#define HEAP4_ALIGN                     (8u)
+#define HEAP4_MIN_BLOCK                 (2u * HEAP4_HEADER)
+#define HEAP4_ALLOCATED                 (0x80000000u)
+
+/* newlib-nano malloc on a 32-bit device: 4 byte size header, 4 byte chunk
+ * alignment and 4 bytes of padding for the 8 byte payload alignment */
+#define NANO_CHUNK_OFFSET               (4u)
+#define NANO_CHUNK_ALIGN                (4u)
+#define NANO_PADDING                    (4u)
+#define NANO_MIN_CHUNK                  (NANO_CHUNK_OFFSET + NANO_PADDING + 4u)
+
+#define REPLAY_ALIGN_UP(x, a)           (((x) + ((a) - 1u)) & ~((a) - 1u))
+
+/*******************************************************************************
+ * Variables Definitions
+ ******************************************************************************/
+typedef struct
+{
+    unsigned long ptr;                          /* device pointer */
+    unsigned int size;                          /* 0 for a release */
+    unsigned int cycles;                        /* device latency */
+} replay_op_t;
+
+/* Device pointer of a live block and its copies in the replayed heaps */
+typedef struct
+{
+    unsigned long ptr;
+    void *p_block[REPLAY_NUM_HEAPS];
+} replay_live_t;
+
+/* Heap modelled on 32-bit offsets into an arena */
+typedef struct
+{
+    uint8_t *p_mem;
+    uint32_t size;
+    uint32_t start_next;                        /* heap_4 xStart, nano free list */
+    uint32_t end;                               /* heap_4 end marker, nano break */
+    uint32_t free_bytes;
+} model_heap_t;
+
+/* A replayed heap and its results */
+typedef struct
+{
+    const char *name;
+    void *(*alloc)(unsigned int size);
+    void (*release)(void *p_block);
+    size_t (*largest_free)(void);
+    size_t (*free_bytes)(void);
+    double ns[REPLAY_MAX_OPS];
+    unsigned int count;
+    unsigned int failed;
+    unsigned int worst_frag;                    /* per mille */
+    size_t min_free;
+} replay_heap_t;
+
+static replay_op_t ops[REPLAY_MAX_OPS];
+static unsigned int num_ops = 0u;
+static replay_live_t live[REPLAY_MAX_LIVE];
+static unsigned int num_live = 0u;
+static double device_cycles[REPLAY_MAX_OPS];
+
+static tlsf_heap_t tlsf;
+static model_heap_t heap4;
+static model_heap_t nano;
+static uint64_t tlsf_arena[REPLAY_ARENA_SIZE / sizeof(uint64_t)];
+static uint64_t heap4_arena[REPLAY_ARENA_SIZE / sizeof(uint64_t)];
+static uint64_t nano_arena[REPLAY_ARENA_SIZE / sizeof(uint64_t)];
+
+/*******************************************************************************
+ * Function Name: model_word
+ *******************************************************************************
+ * Summary:
+ *  Access a 32-bit word of a model arena.
+ *
+ * Parameters:
+ *  model_heap_t *p_heap : heap model
+ *  uint32_t offset : byte offset of the word
+ *
+ * Return:
+ *  uint32_t * : the word
+ *
+ ******************************************************************************/
+static uint32_t *model_word(model_heap_t *p_heap, uint32_t offset)
+{
+    return (uint32_t *)(void *)(p_heap->p_mem + offset);
+}
+
+/*******************************************************************************
+ * Function Name: heap4_next
+ *******************************************************************************
+ * Summary:
+ *  Link to the next free block of a heap_4 block, or of xStart.
+ *
+ ******************************************************************************/
+static uint32_t *heap4_next(uint32_t block)
+{
+    return (MODEL_START == block) ? &heap4.start_next : model_word(&heap4, block);
+}
+
+/*******************************************************************************
+ * Function Name: heap4_size
+ *******************************************************************************
+ * Summary:
+ *  Size field of a heap_4 block.
+ *
+ ******************************************************************************/
+static uint32_t *heap4_size(uint32_t block)
+{
+    return model_word(&heap4, block + 4u);
+}
+
+/*******************************************************************************
+ * Function Name: heap4_init
+ *******************************************************************************
+ * Summary:
+ *  Lay out the heap_4 arena as prvHeapInit() does: one free block that ends at
+ *  the end marker.
+ *
+ * Parameters:
+ *  uint32_t size : configTOTAL_HEAP_SIZE
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void heap4_init(uint32_t size)
+{
+    heap4.p_mem = (uint8_t *)heap4_arena;
+    heap4.size = size;
+    heap4.end = (size - HEAP4_HEADER) & ~(HEAP4_ALIGN - 1u);
+    *heap4_next(heap4.end) = MODEL_NONE;
+    *heap4_size(heap4.end) = 0u;
+    heap4.start_next = 0u;
+    *heap4_next(0u) = heap4.end;
+    *heap4_size(0u) = heap4.end;
+    heap4.free_bytes = heap4.end;
+}
+
+/*******************************************************************************
+ * Function Name: heap4_insert
+ *******************************************************************************
+ * Summary:
+ *  prvInsertBlockIntoFreeList(): insert a block in address order and merge it
+ *  with the free blocks around it.
+ *
+ ******************************************************************************/
+static void heap4_insert(uint32_t block)
+{
+    uint32_t iterator = MODEL_START;
+    uint32_t next;
+
+    while(*heap4_next(iterator) < block)
+    {
+        iterator = *heap4_next(iterator);
+    }
+
+    if((MODEL_START != iterator) && ((iterator + *heap4_size(iterator)) == block))
+    {
+        *heap4_size(iterator) += *heap4_size(block);
+        block = iterator;
+    }
+
+    next = *heap4_next(iterator);
+    if((block + *heap4_size(block)) == next)
+    {
+        if(next != heap4.end)
+        {
+            *heap4_size(block) += *heap4_size(next);
+            *heap4_next(block) = *heap4_next(next);
+        }
+        else
+        {
+            *heap4_next(block) = heap4.end;
+        }
+    }
+    else
+    {
+        *heap4_next(block) = next;
+    }
+
+    if(iterator != block)
+    {
+        *heap4_next(iterator) = block;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: heap4_alloc
+ *******************************************************************************
+ * Summary:
+ *  pvPortMalloc() of heap_4: first fit in address order, the rest of the block
+ *  is split off when it can hold a block.
+ *
+ ******************************************************************************/
+static void *heap4_alloc(unsigned int size)
+{
+    uint32_t wanted = REPLAY_ALIGN_UP(size + HEAP4_HEADER, HEAP4_ALIGN);
+    uint32_t prev = MODEL_START;
+    uint32_t block = heap4.start_next;
+    uint32_t rest;
+
+    if((0u == size) || (wanted > heap4.free_bytes))
+    {
+        return NULL;
+    }
+    while((*heap4_size(block) < wanted) && (MODEL_NONE != *heap4_next(block)))
+    {
+        prev = block;
+        block = *heap4_next(block);
+    }
+    if(block == heap4.end)
+    {
+        return NULL;
+    }
+
+    *heap4_next(prev) = *heap4_next(block);
+    if((*heap4_size(block) - wanted) > HEAP4_MIN_BLOCK)
+    {
+        rest = block + wanted;
+        *heap4_size(rest) = *heap4_size(block) - wanted;
+        *heap4_size(block) = wanted;
+        heap4_insert(rest);
+    }
+    heap4.free_bytes -= *heap4_size(block);
+    *heap4_size(block) |= HEAP4_ALLOCATED;
+    *heap4_next(block) = MODEL_NONE;
+
+    return heap4.p_mem + block;
+}
+
+/*******************************************************************************
+ * Function Name: heap4_release
+ *******************************************************************************
+ * Summary:
+ *  vPortFree() of heap_4.
+ *
+ ******************************************************************************/
+static void heap4_release(void *p_block)
+{
+    uint32_t block = (uint32_t)((uint8_t *)p_block - heap4.p_mem);
+
+    *heap4_size(block) &= ~HEAP4_ALLOCATED;
+    heap4.free_bytes += *heap4_size(block);
+    heap4_insert(block);
+}
+
+/*******************************************************************************
+ * Function Name: heap4_largest_free
+ *******************************************************************************
+ * Summary:
+ *  Largest free block of heap_4, less its header.
+ *
+ ******************************************************************************/
+static size_t heap4_largest_free(void)
+{
+    uint32_t largest = 0u;
+
+    for(uint32_t block = heap4.start_next; block != heap4.end; block = *heap4_next(block))
+    {
+        if(*heap4_size(block) > largest)
+        {
+            largest = *heap4_size(block);
+        }
+    }
+    return (0u == largest) ? 0u : (largest - HEAP4_HEADER);
+}
+
+/*******************************************************************************
+ * Function Name: heap4_free_bytes
+ *******************************************************************************
+ * Summary:
+ *  xPortGetFreeHeapSize() of heap_4.
+ *
+ ******************************************************************************/
+static size_t heap4_free_bytes(void)
+{
+    return heap4.free_bytes;
+}
+
+/*******************************************************************************
+ * Function Name: nano_next
+ *******************************************************************************
+ * Summary:
+ *  Link to the next free chunk of a newlib-nano chunk, or of free_list.
+ *
+ ******************************************************************************/
+static uint32_t *nano_next(uint32_t chunk)
+{
+    return (MODEL_START == chunk) ? &nano.start_next : model_word(&nano, chunk + NANO_CHUNK_OFFSET);
+}
+
+/*******************************************************************************
+ * Function Name: nano_size
+ *******************************************************************************
+ * Summary:
+ *  Size field of a newlib-nano chunk.
+ *
+ ******************************************************************************/
+static uint32_t *nano_size(uint32_t chunk)
+{
+    return model_word(&nano, chunk);
+}
+
+/*******************************************************************************
+ * Function Name: nano_init
+ *******************************************************************************
+ * Summary:
+ *  Start the newlib-nano model with an empty free list and the break at the
+ *  start of the heap.
+ *
+ * Parameters:
+ *  uint32_t size : heap space left by the linker script
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void nano_init(uint32_t size)
+{
+    nano.p_mem = (uint8_t *)nano_arena;
+    nano.size = size;
+    nano.start_next = MODEL_NONE;
+    nano.end = 0u;
+    nano.free_bytes = size;
+}
+
+/*******************************************************************************
+ * Function Name: nano_alloc
+ *******************************************************************************
+ * Summary:
+ *  nano_malloc(): first fit in the free list, which is in address order. The
+ *  allocation is cut from the end of a larger chunk. Without a fit, the heap
+ *  grows with sbrk().
+ *
+ ******************************************************************************/
+static void *nano_alloc(unsigned int size)
+{
+    uint32_t alloc_size = REPLAY_ALIGN_UP(size, NANO_CHUNK_ALIGN) + NANO_PADDING + NANO_CHUNK_OFFSET;
+    uint32_t prev = MODEL_START;
+    uint32_t chunk;
+    uint32_t rem;
+
+    if(alloc_size < NANO_MIN_CHUNK)
+    {
+        alloc_size = NANO_MIN_CHUNK;
+    }
+
+    for(chunk = nano.start_next; MODEL_NONE != chunk; chunk = *nano_next(chunk))
+    {
+        if(*nano_size(chunk) >= alloc_size)
+        {
+            rem = *nano_size(chunk) - alloc_size;
+            if(rem >= NANO_MIN_CHUNK)
+            {
+                *nano_size(chunk) = rem;
+                chunk += rem;
+                *nano_size(chunk) = alloc_size;
+            }
+            else
+            {
+                *nano_next(prev) = *nano_next(chunk);
+            }
+            nano.free_bytes -= *nano_size(chunk);
+            return nano.p_mem + chunk;
+        }
+        prev = chunk;
+    }
+
+    if((nano.size - nano.end) < alloc_size)
+    {
+        return NULL;
+    }
+    chunk = nano.end;
+    nano.end += alloc_size;
+    *nano_size(chunk) = alloc_size;
+    nano.free_bytes -= alloc_size;
+    return nano.p_mem + chunk;
+}
+
+/*******************************************************************************
+ * Function Name: nano_release
+ *******************************************************************************
+ * Summary:
+ *  nano_free(): insert the chunk in address order and merge it with the free
+ *  chunks around it. Memory is never given back to sbrk().
+ *
+ ******************************************************************************/
+static void nano_release(void *p_block)
+{
+    uint32_t chunk = (uint32_t)((uint8_t *)p_block - nano.p_mem);
+    uint32_t prev = MODEL_START;
+    uint32_t next = nano.start_next;
+
+    nano.free_bytes += *nano_size(chunk);
+
+    while((MODEL_NONE != next) && (next < chunk))
+    {
+        prev = next;
+        next = *nano_next(next);
+    }
+
+    if((MODEL_NONE != next) && ((chunk + *nano_size(chunk)) == next))
+    {
+        *nano_size(chunk) += *nano_size(next);
+        *nano_next(chunk) = *nano_next(next);
+    }
+    else
+    {
+        *nano_next(chunk) = next;
+    }
+
+    if((MODEL_START != prev) && ((prev + *nano_size(prev)) == chunk))
+    {
+        *nano_size(prev) += *nano_size(chunk);
+        *nano_next(prev) = *nano_next(chunk);
+    }
+    else
+    {
+        *nano_next(prev) = chunk;
+    }
+}
+
+/*******************************************************************************
+ * Function Name: nano_largest_free
+ *******************************************************************************
+ * Summary:
+ *  Largest allocation newlib-nano can serve, from a free chunk or the space
+ *  above the break.
+ *
+ ******************************************************************************/
+static size_t nano_largest_free(void)
+{
+    uint32_t largest = nano.size - nano.end;
+
+    for(uint32_t chunk = nano.start_next; MODEL_NONE != chunk; chunk = *nano_next(chunk))
+    {
+        if(*nano_size(chunk) > largest)
+        {
+            largest = *nano_size(chunk);
+        }
+    }
+    return (largest < (NANO_CHUNK_OFFSET + NANO_PADDING)) ? 0u : (largest - NANO_CHUNK_OFFSET - NANO_PADDING);
+}
+
+/*******************************************************************************
+ * Function Name: nano_free_bytes
+ *******************************************************************************
+ * Summary:
+ *  Free chunks and the space above the break.
+ *
+ ******************************************************************************/
+static size_t nano_free_bytes(void)
+{
+    return nano.free_bytes;
+}
+
+/*******************************************************************************
+ * Function Name: tlsf_alloc
+ *******************************************************************************
+ * Summary:
+ *  Wrappers of the TLSF heap for the replay table.
+ *
+ ******************************************************************************/
+static void *tlsf_alloc(unsigned int size)
+{
+    return tlsf_heap_alloc(&tlsf, size);
+}
+
+static void tlsf_release(void *p_block)
+{
+    tlsf_heap_free(&tlsf, p_block);
+}
+
+static size_t tlsf_largest_free(void)
+{
+    return tlsf_heap_largest_free(&tlsf);
+}
+
+static size_t tlsf_free_bytes(void)
+{
+    return tlsf.free_bytes;
+}
+
+static replay_heap_t heaps[REPLAY_NUM_HEAPS] =
+{
+    { .name = "TLSF",   .alloc = tlsf_alloc,  .release = tlsf_release,
+      .largest_free = tlsf_largest_free,  .free_bytes = tlsf_free_bytes },
+    { .name = "heap_4", .alloc = heap4_alloc, .release = heap4_release,
+      .largest_free = heap4_largest_free, .free_bytes = heap4_free_bytes },
+    { .name = "newlib", .alloc = nano_alloc,  .release = nano_release,
+      .largest_free = nano_largest_free,  .free_bytes = nano_free_bytes },
+};
+
+/*******************************************************************************
+ * Function Name: replay_now_ns
+ *******************************************************************************
+ * Summary:
+ *  Monotonic time.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  double : time in nanoseconds
+ *
+ ******************************************************************************/
+static double replay_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+/*******************************************************************************
+ * Function Name: replay_compare
+ *******************************************************************************
+ * Summary:
+ *  qsort comparison of two latencies.
+ *
+ ******************************************************************************/
+static int replay_compare(const void *p_a, const void *p_b)
+{
+    double a = *(const double *)p_a;
+    double b = *(const double *)p_b;
+
+    return (a > b) - (a < b);
+}
+
+/*******************************************************************************
+ * Function Name: replay_print_percentiles
+ *******************************************************************************
+ * Summary:
+ *  Sort latencies and print their percentiles.
+ *
+ * Parameters:
+ *  const char *name : allocator name
+ *  const char *unit : latency unit
+ *  double *p_values : latencies, sorted in place
+ *  unsigned int count : number of latencies
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void replay_print_percentiles(const char *name, const char *unit, double *p_values, unsigned int count)
+{
+    if(0u == count)
+    {
+        return;
+    }
+    qsort(p_values, count, sizeof(double), replay_compare);
+    printf("%-8s p50 %8.0f  p90 %8.0f  p99 %8.0f  max %8.0f %s over %u ops\n", name,
+           p_values[(count * 50u) / 100u], p_values[(count * 90u) / 100u], p_values[(count * 99u) / 100u],
+           p_values[count - 1u], unit, count);
+}
+
+/*******************************************************************************
+ * Function Name: replay_find
+ *******************************************************************************
+ * Summary:
+ *  Find the live block of a device pointer.
+ *
+ * Parameters:
+ *  unsigned long ptr : device pointer
+ *
+ * Return:
+ *  replay_live_t * : live block, NULL if the trace missed its allocation
+ *
+ ******************************************************************************/
+static replay_live_t *replay_find(unsigned long ptr)
+{
+    for(unsigned int i = 0u; i < num_live; i++)
+    {
+        if(live[i].ptr == ptr)
+        {
+            return &live[i];
+        }
+    }
+    return NULL;
+}
+
+/*******************************************************************************
+ * Function Name: replay_peak_live
+ *******************************************************************************
+ * Summary:
+ *  Count the most blocks the trace keeps live at the same time.
+ *
+ * Parameters:
+ *  None
+ *
+ * Return:
+ *  unsigned int : peak number of live blocks
+ *
+ ******************************************************************************/
+static unsigned int replay_peak_live(void)
+{
+    unsigned int peak = 0u;
+    replay_live_t *p_live;
+
+    for(unsigned int i = 0u; i < num_ops; i++)
+    {
+        if(0u != ops[i].size)
+        {
+            if((0u != ops[i].ptr) && (num_live < REPLAY_MAX_LIVE))
+            {
+                live[num_live++].ptr = ops[i].ptr;
+            }
+        }
+        else if(NULL != (p_live = replay_find(ops[i].ptr)))
+        {
+            *p_live = live[--num_live];
+        }
+        if(num_live > peak)
+        {
+            peak = num_live;
+        }
+    }
+    num_live = 0u;
+
+    return peak;
+}
+
+/*******************************************************************************
+ * Function Name: replay_measure
+ *******************************************************************************
+ * Summary:
+ *  Track the lowest free space and the worst fragmentation of a heap, the
+ *  part of the free space that the largest free block does not cover.
+ *
+ * Parameters:
+ *  replay_heap_t *p_heap : replayed heap
+ *
+ * Return:
+ *  void
+ *
+ ******************************************************************************/
+static void replay_measure(replay_heap_t *p_heap)
+{
+    size_t free_bytes = p_heap->free_bytes();
+    size_t largest = p_heap->largest_free();
+    unsigned int frag;
+
+    if(free_bytes < p_heap->min_free)
+    {
+        p_heap->min_free = free_bytes;
+    }
+    if((0u != free_bytes) && (largest < free_bytes))
+    {
+        frag = (unsigned int)(1000u - ((largest * 1000u) / free_bytes));
+        if(frag > p_heap->worst_frag)
+        {
+            p_heap->worst_frag = frag;
+        }
+    }
+}
+
+/*******************************************************************************
+ * Function Name: main
+ *******************************************************************************
+ * Summary:
+ *  Read the trace from the standard input and replay it.
+ *
+ ******************************************************************************/
+int main(void)
+{
+    char line[256];
+    char name[32] = "?";
+    unsigned long heap_size = REPLAY_DEFAULT_HEAP_SIZE;
+    unsigned long tlsf_size;
+    unsigned int peak_live;
+    unsigned int num_device = 0u;
+    replay_live_t *p_live;
+    replay_heap_t *p_heap;
+    double start;
+
+    while(fgets(line, sizeof(line), stdin) != NULL)
+    {
+        char *p = strstr(line, "HT ");
+
+        if(NULL == p)
+        {
+            continue;
+        }
+        if(2 == sscanf(p, "HT begin %31s %lu", name, &heap_size))
+        {
+            num_ops = 0u;
+            continue;
+        }
+        if(0 == strncmp(p, "HT end", 6u))
+        {
+            break;
+        }
+        if((num_ops < REPLAY_MAX_OPS) &&
+           (3 == sscanf(p, "HT %lx %u %u", &ops[num_ops].ptr, &ops[num_ops].size, &ops[num_ops].cycles)))
+        {
+            num_ops++;
+        }
+    }
+
+    /* The device heap size, plus the larger host TLSF headers of the blocks
+     * live at the same time and of the free blocks between them */
+    peak_live = replay_peak_live();
+    tlsf_size = heap_size + ((2u * (unsigned long)peak_live + 1u) * REPLAY_TLSF_EXTRA_HEADER);
+    if(tlsf_size > REPLAY_ARENA_SIZE)
+    {
+        tlsf_size = REPLAY_ARENA_SIZE;
+    }
+    if(heap_size > REPLAY_ARENA_SIZE)
+    {
+        heap_size = REPLAY_ARENA_SIZE;
+    }
+    tlsf_heap_init(&tlsf, tlsf_arena, tlsf_size);
+    heap4_init((uint32_t)heap_size);
+    nano_init((uint32_t)heap_size);
+    for(unsigned int h = 0u; h < REPLAY_NUM_HEAPS; h++)
+    {
+        heaps[h].min_free = heaps[h].free_bytes();
+    }
+    printf("Replaying %u operations captured with %s, %lu byte heap, %u blocks live at most\n",
+           num_ops, name, heap_size, peak_live);
+
+    for(unsigned int i = 0u; i < num_ops; i++)
+    {
+        device_cycles[num_device++] = ops[i].cycles;
+
+        if(0u != ops[i].size)
+        {
+            if((0u == ops[i].ptr) || (num_live >= REPLAY_MAX_LIVE))
+            {
+                continue;
+            }
+            p_live = &live[num_live++];
+            p_live->ptr = ops[i].ptr;
+        }
+        else
+        {
+            p_live = replay_find(ops[i].ptr);
+            if(NULL == p_live)
+            {
+                continue;
+            }
+        }
+
+        for(unsigned int h = 0u; h < REPLAY_NUM_HEAPS; h++)
+        {
+            p_heap = &heaps[h];
+            if(0u != ops[i].size)
+            {
+                start = replay_now_ns();
+                p_live->p_block[h] = p_heap->alloc(ops[i].size);
+                p_heap->ns[p_heap->count++] = replay_now_ns() - start;
+                p_heap->failed += (NULL == p_live->p_block[h]) ? 1u : 0u;
+            }
+            else if(NULL != p_live->p_block[h])
+            {
+                start = replay_now_ns();
+                p_heap->release(p_live->p_block[h]);
+                p_heap->ns[p_heap->count++] = replay_now_ns() - start;
+            }
+            replay_measure(p_heap);
+        }
+
+        if(0u == ops[i].size)
+        {
+            *p_live = live[--num_live];
+        }
+    }
+
+    replay_print_percentiles("device", "cycles", device_cycles, num_device);
+    for(unsigned int h = 0u; h < REPLAY_NUM_HEAPS; h++)
+    {
+        replay_print_percentiles(heaps[h].name, "ns", heaps[h].ns, heaps[h].count);
+    }
+    for(unsigned int h = 0u; h < REPLAY_NUM_HEAPS; h++)
+    {
+        printf("%-8s worst fragmentation %u.%u%%, lowest free %zu bytes, %u failed allocations\n",
+               heaps[h].name, heaps[h].worst_frag / 10u, heaps[h].worst_frag % 10u, heaps[h].min_free,
+               heaps[h].failed);
+    }
+
+    return 0;
+}
+
+/* [] END OF FILE */